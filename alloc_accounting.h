@@ -0,0 +1,155 @@
+/*
+ * alloc_accounting.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_ALLOC_ACCOUNTING_H_
+#define LOG4HPP_ALLOC_ACCOUNTING_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace log4hpp {
+
+///Counts heap allocations, which happen inside of a log call (debug tool)
+/**
+ * Enabled by the macro LOG4HPP_ALLOC_ACCOUNTING (must be defined for whole program). Exactly one
+ * translation unit must also define LOG4HPP_ALLOC_ACCOUNTING_IMPL before the include, it
+ * defines replacement of global operator new, which reports allocations to this class.
+ *
+ * @code
+ * log4hpp::GlobalContext::current().setZeroAllocation(4096);
+ * ...
+ * auto before = log4hpp::AllocAccounting::get();
+ * log::info("Hello {}", 42);
+ * assert(log4hpp::AllocAccounting::get().allocations == before.allocations);
+ * @endcode
+ *
+ * Aligned operator new is not counted
+ */
+class AllocAccounting {
+public:
+
+	struct Counters {
+		///count of allocations
+		std::size_t allocations = 0;
+		///total allocated bytes
+		std::size_t bytes = 0;
+	};
+
+	///Function called for each allocation inside of a log call
+	/** The function must not allocate memory (such allocations are not reported) */
+	using Reporter = void (*)(std::size_t size);
+
+	///Marks the log call (created by the logging functions)
+	class Scope {
+	public:
+		Scope() {++state().depth;}
+		~Scope() {--state().depth;}
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+	};
+
+	///Returns allocations inside log calls of all threads
+	static Counters get() {
+		return Counters{allocations.load(std::memory_order_relaxed), bytes.load(std::memory_order_relaxed)};
+	}
+	///Returns allocations inside log calls of the current thread
+	static Counters getThread() {
+		return state().counters;
+	}
+	///Resets all counters (counters of other threads are not reset)
+	static void reset() {
+		allocations.store(0, std::memory_order_relaxed);
+		bytes.store(0, std::memory_order_relaxed);
+		state().counters = Counters();
+	}
+	///Sets reporter
+	static void setReporter(Reporter r) {
+		reporter.store(r, std::memory_order_relaxed);
+	}
+	///Returns true, if the current thread is inside of a log call
+	static bool inLogCall() {return state().depth > 0;}
+
+	///Called by operator new
+	static void onAlloc(std::size_t sz) {
+		ThreadState &st = state();
+		if (st.depth == 0 || st.reporting) return;
+		++st.counters.allocations;
+		st.counters.bytes += sz;
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(sz, std::memory_order_relaxed);
+		Reporter r = reporter.load(std::memory_order_relaxed);
+		if (r) {
+			st.reporting = true;
+			r(sz);
+			st.reporting = false;
+		}
+	}
+
+protected:
+	struct ThreadState {
+		unsigned int depth = 0;
+		bool reporting = false;
+		Counters counters;
+	};
+
+	static ThreadState &state() {
+		thread_local ThreadState st;
+		return st;
+	}
+
+	static inline std::atomic<std::size_t> allocations = {0};
+	static inline std::atomic<std::size_t> bytes = {0};
+	static inline std::atomic<Reporter> reporter = {nullptr};
+};
+
+}
+
+#ifdef LOG4HPP_ALLOC_ACCOUNTING
+#define LOG4HPP_ALLOC_SCOPE ::log4hpp::AllocAccounting::Scope _log4hpp_alloc_scope
+#else
+#define LOG4HPP_ALLOC_SCOPE do {} while(false)
+#endif
+
+#ifdef LOG4HPP_ALLOC_ACCOUNTING_IMPL
+#include <cstdlib>
+#include <new>
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+//false positive: replaced operator new is implemented by malloc
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t sz) {
+	log4hpp::AllocAccounting::onAlloc(sz);
+	void *p = std::malloc(sz?sz:1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void *operator new[](std::size_t sz) {
+	return operator new(sz);
+}
+void *operator new(std::size_t sz, const std::nothrow_t &) noexcept {
+	log4hpp::AllocAccounting::onAlloc(sz);
+	return std::malloc(sz?sz:1);
+}
+void *operator new[](std::size_t sz, const std::nothrow_t &tag) noexcept {
+	return operator new(sz, tag);
+}
+void operator delete(void *p) noexcept {std::free(p);}
+void operator delete[](void *p) noexcept {std::free(p);}
+void operator delete(void *p, std::size_t) noexcept {std::free(p);}
+void operator delete[](void *p, std::size_t) noexcept {std::free(p);}
+void operator delete(void *p, const std::nothrow_t &) noexcept {std::free(p);}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {std::free(p);}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+#endif /* LOG4HPP_ALLOC_ACCOUNTING_H_ */
@@ -8,6 +8,12 @@
 #ifndef LOG4HPP_APPENDER_H_
 #define LOG4HPP_APPENDER_H_
 
+#include <cstdint>
+#include <string_view>
+#include <unistd.h>
+
+#include "level.h"
+
 namespace log4hpp {
 
 
@@ -25,6 +31,85 @@ public:
 
 };
 
+///Information about the line, which is passed to appenders which accept it
+/**
+ * Appender can define operator()(const std::string_view &line, const LineInfo &info). Otherwise
+ * operator()(const std::string_view &line) is called
+ */
+struct LineInfo {
+	///level of the message (Level::nolevel for lines which don't belong to a message)
+	Level::Type level = Level::nolevel;
+	///thread id
+	ThreadId threadId = 0;
+	///time of the message in nanoseconds since epoch (0 - unknown, for example a line of the flight recorder,
+	///or not computed, because neither the format nor the appender needs it - see needs_time())
+	std::int64_t time = 0;
+	///number of the message {N} (0 - the format doesn't contain {N})
+	std::uint64_t seq = 0;
+};
+
+namespace _details {
+
+	///Sends line to the appender, passes the line info if the appender accepts it
+	template<typename Appender>
+	auto appendLine(Appender &app, const std::string_view &line, const LineInfo &info, int) -> decltype(app(line, info)) {
+		return app(line, info);
+	}
+	template<typename Appender>
+	void appendLine(Appender &app, const std::string_view &line, const LineInfo &, long) {
+		app(line);
+	}
+
+	///Writes line from the crash handler
+	/** Appender can define function crash_write(line) which must be async-signal-safe. Otherwise
+	 * the line is written to the stderr
+	 */
+	template<typename Appender>
+	auto crashWrite(Appender &app, const std::string_view &line, int) -> decltype(app.crash_write(line)) {
+		return app.crash_write(line);
+	}
+	template<typename Appender>
+	void crashWrite(Appender &, const std::string_view &line, long) {
+		std::size_t p = 0;
+		while (p < line.size()) {
+			auto s = ::write(STDERR_FILENO, line.data()+p, line.size()-p);
+			if (s <= 0) break;
+			p+=s;
+		}
+	}
+
+	///Flushes buffered data from the crash handler
+	/** Appender can define function crash_flush() which must be async-signal-safe */
+	template<typename Appender>
+	auto crashFlush(Appender &app, int) -> decltype(app.crash_flush()) {
+		return app.crash_flush();
+	}
+	template<typename Appender>
+	void crashFlush(Appender &, long) {}
+
+	///Collects statistics of the appender
+	/** Appender can define function stats(BackendStats &) which adds its counters (dropped
+	 * messages, write errors, queue depth) to the snapshot */
+	template<typename Appender, typename Stats>
+	auto appenderStats(const Appender &app, Stats &st, int) -> decltype(app.stats(st)) {
+		return app.stats(st);
+	}
+	template<typename Appender, typename Stats>
+	void appenderStats(const Appender &, Stats &, long) {}
+
+	///Returns true, if the appender uses LineInfo::time
+	/** Appender can define function needs_time(). Otherwise the time is passed only when the
+	 * backend computes it anyway (the format contains the time), else it is zero */
+	template<typename Appender>
+	auto appenderNeedsTime(const Appender &app, int) -> decltype(static_cast<bool>(app.needs_time())) {
+		return app.needs_time();
+	}
+	template<typename Appender>
+	bool appenderNeedsTime(const Appender &, long) {return false;}
+
+}
+
+
 }
 
 
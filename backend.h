@@ -8,9 +8,15 @@
 #ifndef LOG4HPP_BACKEND_H_
 #define LOG4HPP_BACKEND_H_
 
+#include <algorithm>
+#include <atomic>
+#include <string>
 #include <string_view>
 #include <memory>
 #include "level.h"
+#include "flight_recorder.h"
+#include "appender.h"
+#include "stats.h"
 
 namespace log4hpp {
 
@@ -37,11 +43,70 @@ public:
 	/** @param line line to send */
 	virtual void direct_send(const std::string_view &line) = 0;
 	virtual Level::Type getLevel() const = 0;
+	///Sends content of the flight recorder to the appender (if the recorder is enabled)
+	virtual void dumpFlightRecorder() {}
+	///Called from the crash handler
+	/**
+	 * Function must be async-signal-safe. It should write all buffered data and a final line
+	 * which reports the signal.
+	 * @param sig signal number
+	 */
+	virtual void crash_dump(int) noexcept {}
+	///Returns snapshot of statistics
+	/** Function can be called from any thread */
+	virtual BackendStats getStats() const {return BackendStats();}
 	virtual ~IBackend() {}
 
 };
 
+namespace _details {
+
+	///New line of the platform ({nl})
+	static constexpr std::string_view platformNewLine =
+		#ifdef _WIN32
+			"\r\n";
+		#elif defined macintosh // OS 9
+			"\r";
+		#else
+			"\n";
+		#endif
+
+	///Returns line terminator at the end of the format ({nl}, {lf}, {cr} or literal new line characters)
+	inline std::string lineTerminator(std::string_view format) {
+		std::string res;
+		while (!format.empty()) {
+			std::string_view t;
+			std::size_t n = 4;
+			if (format.size() >= 4 && format.substr(format.size()-4) == "{nl}") t = platformNewLine;
+			else if (format.size() >= 4 && format.substr(format.size()-4) == "{lf}") t = "\n";
+			else if (format.size() >= 4 && format.substr(format.size()-4) == "{cr}") t = "\r";
+			else if (format.back() == '\n' || format.back() == '\r') {
+				t = format.substr(format.size()-1);
+				n = 1;
+			} else {
+				break;
+			}
+			res.insert(0, t);
+			format.remove_suffix(n);
+		}
+		return res;
+	}
 
+}
+
+///Numbering of messages ({N})
+enum class Numbering {
+	///single shared counter, numbers are consecutive (default)
+	global,
+	///every thread reserves a block of numbers from the shared counter. Numbers are unique
+	///and increasing in the thread, the shared counter is touched once per block
+	block,
+	///every thread has own sequence starting by 1. The pair ({T},{N}) is unique
+	thread,
+	///hybrid logical clock per thread - (time of the message in milliseconds since epoch << 16) + logical counter. Numbers
+	///are increasing in the thread, pair ({N},{T}) gives total order consistent with time
+	hlc
+};
 
 template<typename Appender>
 class BackendT: public IBackend {
@@ -49,17 +114,67 @@ public:
 
 	template<typename ... Args>
 	BackendT(const std::string_view &format, Level::Type level, Args && ... appender)
-		:format(format),level(level),appender(std::forward<Args>(appender)...) {}
+		:format(format),level(level),appender(std::forward<Args>(appender)...)
+		,truncatedEnd("...[truncated]" + _details::lineTerminator(format))
+		,timeInFormat(format.find("{t") != format.npos) {}
 
 
 	void initCounter(std::size_t cnt) {this->msgcnt = cnt;}
 
+	///Sets numbering scheme of messages
+	/**
+	 * Should be called before the backend is installed, threads keep their numbering state
+	 *
+	 * @param n numbering scheme
+	 * @param blockSize size of the block for Numbering::block
+	 */
+	void setNumbering(Numbering n, std::size_t blockSize = 4096) {
+		numbering = n;
+		this->blockSize = blockSize?blockSize:1;
+	}
+
+	///Sets sampling of the write latency histogram
+	/**
+	 * Measuring the write costs two reads of the clock, so only every n-th write is measured.
+	 *
+	 * @param n measure every n-th write (rounded up to the power of two), 0 - disabled, 1 - every write
+	 */
+	void setLatencySampling(std::size_t n) {
+		std::size_t p = 1;
+		while (p < n) p <<= 1;
+		latencyMask = n?p-1:~std::size_t(0);
+	}
+
 	virtual void send(ThreadContext &thr, Level::Type level, const AbstractContext *context, const std::string_view &message);
-	virtual void direct_send(const std::string_view &line) {appender(line);}
+	virtual void direct_send(const std::string_view &line);
 	virtual Level::Type getLevel() const {
-		return level;
+		return recorder?std::max(level, recordLevel):level;
 	}
 
+	///Enables flight recorder
+	/**
+	 * Messages which are not enabled by the backend level are stored in the memory ring (text,
+	 * level, thread and time). The ring is sent to the appender when more important message is logged,
+	 * or on explicit request (dumpFlightRecorder), the lines are rendered by the format at that time.
+	 * Context of the recorded messages is not kept. Threads receive the level during initialization,
+	 * so the recorder should be enabled before the backend is installed.
+	 *
+	 * @param slots count of messages kept in the memory
+	 * @param slotSize maximum size of the message
+	 * @param recordLevel maximum level recorded in the memory
+	 * @param dumpLevel level which triggers the dump of the recorder
+	 */
+	void enableFlightRecorder(std::size_t slots = 4096, std::size_t slotSize = 256,
+			Level::Type recordLevel = Level::max_verbose, Level::Type dumpLevel = Level::error) {
+		recorder = std::make_unique<FlightRecorder>(slots, slotSize);
+		this->recordLevel = recordLevel;
+		this->dumpLevel = dumpLevel;
+	}
+
+	virtual void dumpFlightRecorder();
+	virtual void crash_dump(int sig) noexcept;
+	virtual BackendStats getStats() const;
+
 	Appender *operator->() {
 		return &appender;
 	}
@@ -73,7 +188,37 @@ protected:
 	std::string format;
 	Level::Type level;
 	Appender appender;
-	std::atomic<std::size_t> msgcnt;
+	std::atomic<std::size_t> msgcnt = {0};
+	Numbering numbering = Numbering::global;
+	std::size_t blockSize = 4096;
+	std::unique_ptr<FlightRecorder> recorder;
+	Level::Type recordLevel = Level::nolevel;
+	Level::Type dumpLevel = Level::nolevel;
+	StatsCounters counters;
+	///end of the line, which doesn't fit to the bounded buffer of the thread - mark and the line terminator
+	std::string truncatedEnd;
+	///format contains the time {t}
+	bool timeInFormat;
+	///mask of the write number, the write is measured when the masked number is zero
+	std::size_t latencyMask = 63;
+
+	///Returns true, if the time of the message is needed (format, numbering or appender)
+	bool needsTime() const {
+		return timeInFormat || numbering == Numbering::hlc || _details::appenderNeedsTime(appender, 0);
+	}
+
+	///Returns next message number for {N}
+	std::size_t nextNumber(ThreadContext &thr, std::int64_t time);
+
+	///Renders the line by the format to thr.bk_buffer
+	/**
+	 * @return number of the message ({N}), or 0, if the format doesn't contain {N}
+	 */
+	std::size_t render(ThreadContext &thr, ThreadId threadId, Level::Type level,
+			const AbstractContext *context, const std::string_view &message, std::int64_t time);
+
+	///Sends line to the appender, measures sampled writes
+	void write(StatsCounters::Shard &shard, const std::string_view &line, const LineInfo &info);
 };
 
 
@@ -93,6 +238,14 @@ public:
 	void direct_send(const std::string_view &line) {ptr->direct_send(line);}
 	Level::Type getLevel() const {return ptr->getLevel();}
 	void initCounter(std::size_t cnt) {ptr->initCounter(cnt);}
+	void setNumbering(Numbering n, std::size_t blockSize = 4096) {ptr->setNumbering(n, blockSize);}
+	void setLatencySampling(std::size_t n) {ptr->setLatencySampling(n);}
+	void enableFlightRecorder(std::size_t slots = 4096, std::size_t slotSize = 256,
+			Level::Type recordLevel = Level::max_verbose, Level::Type dumpLevel = Level::error) {
+		ptr->enableFlightRecorder(slots, slotSize, recordLevel, dumpLevel);
+	}
+	void dumpFlightRecorder() {ptr->dumpFlightRecorder();}
+	BackendStats getStats() const {return ptr->getStats();}
 
 	std::shared_ptr<BackendT<Appender> > getImpl() const {return ptr;}
 
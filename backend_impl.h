@@ -8,6 +8,9 @@
 #ifndef BACKEND_IMPL_H_
 #define BACKEND_IMPL_H_
 
+#include <csignal>
+#include <cstring>
+#include <ctime>
 #include "context.h"
 #include "backend.h"
 
@@ -28,36 +31,99 @@ static inline void outLevelName(int level, Buffer &out) {
 	}
 }
 
+namespace _details {
+
+	///Copies strftime format, replaces %N by nanoseconds and %1N-%9N by first 1-9 digits of the fraction of second
+	inline void expandTimeFormat(const std::string_view &fmt, std::int64_t nsec, Buffer &out) {
+		for (std::size_t i = 0; i < fmt.size(); i++) {
+			char c = fmt[i];
+			if (c == '%' && i+1 < fmt.size()) {
+				char d = fmt[i+1];
+				unsigned int digits = 0;
+				if (d == 'N') {
+					digits = 9;
+				} else if (d >= '1' && d <= '9' && i+2 < fmt.size() && fmt[i+2] == 'N') {
+					digits = d - '0';
+					++i;
+				}
+				if (digits) {
+					char buf[9];
+					for (int k = 8; k >= 0; k--) {
+						buf[k] = '0' + static_cast<char>(nsec % 10);
+						nsec /= 10;
+					}
+					out.append(buf, digits);
+				} else {
+					out.push_back(c);
+					out.push_back(d);
+				}
+				++i;
+			} else {
+				out.push_back(c);
+			}
+		}
+	}
+
+}
+
 
 
 template<typename Appender>
 inline void BackendT<Appender>::send(ThreadContext &thr,
 							Level::Type level, const AbstractContext *context,
 							const std::string_view &message) {
+	auto &shard = counters.shard(thr.threadId);
+	if (level > this->level && level > thr.ctxLevel) {
+		StatsCounters::Shard::inc(shard.filtered);
+		//only the message is stored, the line is rendered when the recorder is dumped
+		if (recorder) recorder->record(level, thr.threadId, thr.time?thr.time:Timestamp::now(), message);
+		return;
+	}
+	if (recorder && level <= dumpLevel) dumpFlightRecorder();
+	//time is captured at the call site, conversion to the wall-clock time happens here (if needed)
+	std::int64_t time = 0;
+	if (needsTime()) time = thr.time?Timestamp::toRealtime(thr.time):Timestamp::realtime();
+	std::size_t seq = render(thr, thr.threadId, level, context, message, time);
+	StatsCounters::Shard::inc(shard.accepted);
+	write(shard, thr.bk_buffer, LineInfo{level, thr.threadId, time, seq});
+}
+
+template<typename Appender>
+inline std::size_t BackendT<Appender>::render(ThreadContext &thr, ThreadId threadId,
+							Level::Type level, const AbstractContext *context,
+							const std::string_view &message, std::int64_t time) {
 	Buffer &buffer = thr.fmt_buffer;
-	std::time_t tm = std::time(nullptr);
+	std::time_t tm = static_cast<std::time_t>(time / 1000000000);
+	std::size_t seq = 0;
 
 	auto smap = [&](const std::string_view &type, auto &&out) {
 		if (!type.empty()) {
 			switch(type[0]) {
 			case 't': {
 				buffer.clear();
+				struct tm tmbuf;
+				gmtime_r(&tm, &tmbuf);
 				if (type.length()>1) {
 					auto fmt = type.substr(1);
 					if (fmt.length()>1 && fmt[0] == '[' && fmt[fmt.size()-1] == ']') {
 						fmt = fmt.substr(1, fmt.size()-2);
 					}
-					auto needsz = fmt.length()*5;
-					buffer.resize(needsz);
-					buffer.append(fmt);
-					auto cnt = std::strftime(buffer.data(),needsz,buffer.data()+needsz, gmtime(&tm));
-					buffer.resize(cnt);
+					_details::expandTimeFormat(fmt, time % 1000000000, buffer);
+					buffer.push_back('\0');
+					//the format doesn't fit to the bounded buffer
+					if (buffer.data()[buffer.size()-1] != 0) {out(std::string_view());break;}
+					auto fmtsz = buffer.size();
+					//the bounded buffer may give less space, strftime returns 0 if the result doesn't fit
+					buffer.resize(fmtsz+fmtsz*5);
+					auto needsz = buffer.size()-fmtsz;
+					auto cnt = needsz?std::strftime(buffer.data()+fmtsz,needsz,buffer.data(), &tmbuf):0;
+					out(std::string_view(buffer.data()+fmtsz, cnt));
 				} else {
 					buffer.resize(50);
-					auto cnt = std::strftime(buffer.data(),50,"%FT%TZ" , gmtime(&tm));
+					auto cnt = buffer.size()?std::strftime(buffer.data(),buffer.size(),"%FT%TZ" , &tmbuf):0;
 					buffer.resize(cnt);
+					out(buffer);
 				}
-				out(buffer);
 			}break;
 			case 'c': {
 				if (type == "cr") {
@@ -65,9 +131,10 @@ inline void BackendT<Appender>::send(ThreadContext &thr,
 				} else {
 					buffer.clear();
 					if (context) {
+						auto sep = type.substr(1);
 						context->walk([&](const AbstractContext *c){
-							c->toString(buffer);
-							if (c != context) buffer.append(type.substr(1));
+							c->toStringChain(buffer, sep, false);
+							if (c != context) buffer.append(sep);
 						});
 					}
 					out(buffer);
@@ -76,18 +143,20 @@ inline void BackendT<Appender>::send(ThreadContext &thr,
 			case 'C': {
 				buffer.clear();
 				auto x = context;
+				auto sep = type.substr(1);
 				while (x) {
-					x->toString(buffer);
+					x->toStringChain(buffer, sep, true);
 					x = x->getPrevContext();
-					if (x) buffer.append(type.substr(1));
+					if (x) buffer.append(sep);
 				}
 				out(buffer);
 			}break;
 			case 'T':
-				out(thr.threadId);
+				out(threadId);
 				break;
 			case 'N':
-				out(++msgcnt);
+				seq = nextNumber(thr, time);
+				out(seq);
 				break;
 			case 'm':
 				out(message);
@@ -109,15 +178,7 @@ inline void BackendT<Appender>::send(ThreadContext &thr,
 				out(level);
 				break;
 			case 'n':
-				if (type == "nl") out(DirectString(
-						#ifdef _WIN32
-							"\r\n"
-						#elif defined macintosh // OS 9
-							"\r"
-						#else
-							"\n"
-						#endif
-						));
+				if (type == "nl") out(DirectString(_details::platformNewLine.data(), _details::platformNewLine.size()));
 				break;
 			}
 		}
@@ -127,21 +188,209 @@ inline void BackendT<Appender>::send(ThreadContext &thr,
 	out.clear();
 	FormatT<Buffer &,decltype(smap)> fmt(out, std::move(smap));
 	fmt(format);
-	appender(out);
+	//the line doesn't fit to the bounded buffer, keep the line terminator
+	if (out.overflow()) out.replaceTail(truncatedEnd);
+	return seq;
+}
+
+template<typename Appender>
+inline std::size_t BackendT<Appender>::nextNumber(ThreadContext &thr, std::int64_t time) {
+	switch (numbering) {
+	default:
+	case Numbering::global:
+		return ++msgcnt;
+	case Numbering::block:
+		if (thr.seqOwner != this || thr.seqNext == thr.seqEnd) {
+			std::size_t b = msgcnt.fetch_add(blockSize, std::memory_order_relaxed);
+			thr.seqNext = b+1;
+			thr.seqEnd = b+1+blockSize;
+			thr.seqOwner = this;
+		}
+		return thr.seqNext++;
+	case Numbering::thread:
+		if (thr.seqOwner != this) {
+			thr.seqNext = 0;
+			thr.seqOwner = this;
+		}
+		return ++thr.seqNext;
+	case Numbering::hlc: {
+		auto ms = time / 1000000;
+		std::size_t pt = static_cast<std::size_t>(ms) << 16;
+		if (thr.seqOwner != this) {
+			thr.seqNext = 0;
+			thr.seqOwner = this;
+		}
+		thr.seqNext = std::max(thr.seqNext+1, pt);
+		return thr.seqNext;
+	}
+	}
+}
+
+template<typename Appender>
+inline void BackendT<Appender>::write(StatsCounters::Shard &shard, const std::string_view &line, const LineInfo &info) {
+	if (shard.write(line.size(), latencyMask)) {
+		auto start = std::chrono::steady_clock::now();
+		_details::appendLine(appender, line, info, 0);
+		shard.measured(std::chrono::steady_clock::now() - start);
+	} else {
+		_details::appendLine(appender, line, info, 0);
+	}
+}
+
+template<typename Appender>
+inline void BackendT<Appender>::direct_send(const std::string_view &line) {
+	auto &thr = ThreadContext::current();
+	write(counters.shard(thr.threadId), line, LineInfo{Level::nolevel, thr.threadId});
+}
+
+template<typename Appender>
+inline BackendStats BackendT<Appender>::getStats() const {
+	BackendStats st;
+	counters.snapshot(st);
+	_details::appenderStats(appender, st, 0);
+	GlobalContext &gc = GlobalContext::current();
+	st.threads = gc.threadCount.load(std::memory_order_relaxed);
+	st.thread_memory = gc.threadMemory.load(std::memory_order_relaxed);
+	st.filtered += gc.filteredMessages();
+	return st;
+}
+
+template<typename Appender>
+inline void BackendT<Appender>::dumpFlightRecorder() {
+	if (!recorder) return;
+	auto &thr = ThreadContext::current();
+	auto &shard = counters.shard(thr.threadId);
+	LineInfo info{Level::nolevel, thr.threadId};
+	bool first = true;
+	recorder->dump([&](const FlightRecorder::Entry &e){
+		if (first) {
+			write(shard, "---- flight recorder begin ----\n", info);
+			first = false;
+		}
+		//numbers are taken only for the lines which are written. Time is not passed to the
+		//appender, the lines are older than the lines already written (time index)
+		std::size_t seq = render(thr, e.threadId, e.level, nullptr, e.message, Timestamp::toRealtime(e.time));
+		write(shard, thr.bk_buffer, LineInfo{e.level, e.threadId, 0, seq});
+	});
+	if (!first) write(shard, "---- flight recorder end ----\n", info);
+}
+
+namespace _details {
+
+	///Builds line "*** fatal signal N (NAME) ***" - async-signal-safe
+	inline std::string_view fatalSignalLine(int sig, char *buff, std::size_t size) {
+		const char *name = "";
+		switch (sig) {
+		case SIGSEGV: name = " (SIGSEGV)";break;
+		case SIGABRT: name = " (SIGABRT)";break;
+		case SIGBUS: name = " (SIGBUS)";break;
+		case SIGILL: name = " (SIGILL)";break;
+		case SIGFPE: name = " (SIGFPE)";break;
+		case SIGTERM: name = " (SIGTERM)";break;
+		default: break;
+		}
+		std::size_t pos = 0;
+		auto put = [&](const char *s) {
+			while (*s && pos < size) buff[pos++] = *s++;
+		};
+		char num[12];
+		int n = 0;
+		unsigned int v = sig;
+		do {num[n++] = '0' + (v % 10); v/=10;} while (v && n < 11);
+		num[n] = 0;
+		for (int i = 0; i < n/2; i++) std::swap(num[i], num[n-i-1]);
+		put("*** fatal signal ");
+		put(num);
+		put(name);
+		put(" ***\n");
+		return std::string_view(buff, pos);
+	}
+
+	///Builds line "*** message in progress: text" - async-signal-safe
+	inline std::string_view pendingMessageLine(const std::string_view &msg, char *buff, std::size_t size) {
+		static constexpr std::string_view prefix = "*** message in progress: ";
+		std::size_t pos = std::min(prefix.size(), size);
+		std::memcpy(buff, prefix.data(), pos);
+		std::size_t len = std::min(msg.size(), size - pos - (pos < size));
+		std::memcpy(buff+pos, msg.data(), len);
+		pos += len;
+		if (pos < size) buff[pos++] = '\n';
+		return std::string_view(buff, pos);
+	}
+
+	///Renders message of the flight recorder "seconds.millis LEVEL thread message" - async-signal-safe
+	/** The format of the backend is not used, because the strftime() is not async-signal-safe */
+	inline std::string_view recordedLine(const FlightRecorder::Entry &e, char *buff, std::size_t size) {
+		static const char *levelName[] = {"","FATAL","ERROR","WARN","NOTE","PROGR","INFO","DEBUG"};
+		std::size_t pos = 0;
+		auto put = [&](const char *s, std::size_t n) {
+			while (n-- && pos < size) buff[pos++] = *s++;
+		};
+		auto putNum = [&](std::uint64_t v, int minDigits) {
+			char num[24];
+			int n = 0;
+			do {num[n++] = '0' + (v % 10); v/=10;} while ((v || n < minDigits) && n < 24);
+			while (n && pos < size) buff[pos++] = num[--n];
+		};
+		std::int64_t ms = Timestamp::toRealtime(e.time) / 1000000;
+		putNum(ms / 1000, 1);
+		put(".", 1);
+		putNum(ms % 1000, 3);
+		put(" ", 1);
+		const char *ln = levelName[(e.level >> 12) & 0x7];
+		put(ln, std::strlen(ln));
+		put(" ", 1);
+		putNum(e.threadId, 1);
+		put(" ", 1);
+		//keep space for the newline
+		std::size_t room = pos < size?size - pos - 1:0;
+		put(e.message.data(), std::min(e.message.size(), room));
+		put("\n", 1);
+		return std::string_view(buff, pos);
+	}
+
+}
+
+template<typename Appender>
+inline void BackendT<Appender>::crash_dump(int sig) noexcept {
+	auto wr = [&](const std::string_view &line) {
+		_details::crashWrite(appender, line, 0);
+	};
+	if (recorder) {
+		wr("---- flight recorder begin ----\n");
+		recorder->dump([&](const FlightRecorder::Entry &e) {
+			char buff[1024];
+			wr(_details::recordedLine(e, buff, sizeof(buff)));
+		});
+		wr("---- flight recorder end ----\n");
+	}
+	_details::crashFlush(appender, 0);
+	char buff[1024];
+	//message which was being formatted or written by the crashing thread
+	ThreadContext *thr = ThreadContext::peek();
+	if (thr && thr->buffer.size()) {
+		wr(_details::pendingMessageLine(thr->buffer, buff, sizeof(buff)));
+	}
+	wr(_details::fatalSignalLine(sig, buff, sizeof(buff)));
 }
 
 inline std::shared_ptr<IBackend> setActiveInThread(std::shared_ptr<IBackend> newBk) {
 	auto &ts = ThreadContext::current();
 	auto cur = ts.backend;
 	ts.backend = newBk;
+	ts.level = newBk->getLevel();
 	return cur;
 
 }
 
 template<typename Appender>
 inline void Backend<Appender>::install() {
+	//calibration of the time conversion takes a while, it is not done by the first log call
+	Timestamp::calibrate();
 	auto &gs = GlobalContext::current();
-	gs.backend = ptr;
+	std::atomic_store(&gs.backend, std::shared_ptr<IBackend>(ptr));
+	//messages logged before the first install are sent to this backend
+	BootstrapBackend::instance()->close(*ptr);
 
 }
 
@@ -155,6 +404,7 @@ inline std::shared_ptr<IBackend> Backend<Appender>::setActive(std::shared_ptr<IB
 	auto &ts = ThreadContext::current();
 	auto cur = ts.backend;
 	ts.backend = bk;
+	ts.level = bk->getLevel();
 	return cur;
 
 }
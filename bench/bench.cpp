@@ -0,0 +1,273 @@
+/*
+ * bench.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Benchmark suite. Results are written to stdout as JSON lines, one object per measurement
+ *
+ * usage: log4hpp-bench [-i iterations] [-t max_threads] [-d tmpfs_dir] [-s selection]
+ *
+ * selection: comma separated list of: latency,threads,stringify,alloc (default all)
+ *
+ * The alloc section counts allocations inside of log calls by AllocAccounting (the bench is built
+ * with LOG4HPP_ALLOC_ACCOUNTING)
+ */
+
+#define LOG4HPP_ALLOC_ACCOUNTING_IMPL
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../logger.h"
+#include "../unix_file_appender.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using FileBackend = log4hpp::Backend<log4hpp::UnixFileAppender>;
+
+struct Config {
+	std::size_t iterations = 200000;
+	unsigned int maxThreads = std::max(1U, std::thread::hardware_concurrency());
+	std::string tmpfs = "/dev/shm";
+	std::string selection = "latency,threads,stringify,alloc";
+
+	bool selected(const char *name) const {
+		return selection.find(name) != selection.npos;
+	}
+};
+
+constexpr std::string_view lineFormat = "{N} {t} {L} {T} {c} {m}{nl}";
+
+double nanos(Clock::duration d) {
+	return std::chrono::duration<double, std::nano>(d).count();
+}
+
+void printLatency(const char *api, std::vector<Clock::duration> &samples, Clock::duration total) {
+	std::sort(samples.begin(), samples.end());
+	auto pct = [&](double p) {
+		std::size_t idx = std::min(samples.size()-1, static_cast<std::size_t>(p * samples.size()));
+		return nanos(samples[idx]);
+	};
+	std::printf("{\"bench\":\"latency\",\"api\":\"%s\",\"iterations\":%zu,"
+			"\"mean_ns\":%.1f,\"p50_ns\":%.1f,\"p99_ns\":%.1f,\"p999_ns\":%.1f,\"max_ns\":%.1f}\n",
+			api, samples.size(), nanos(total)/samples.size(),
+			pct(0.5), pct(0.99), pct(0.999), nanos(samples.back()));
+}
+
+template<typename Fn>
+void measureLatency(const char *api, std::size_t iterations, Fn &&fn) {
+	std::vector<Clock::duration> samples;
+	samples.reserve(iterations);
+	for (std::size_t i = 0; i < iterations/10; i++) fn(i);	//warm-up
+	auto start = Clock::now();
+	for (std::size_t i = 0; i < iterations; i++) {
+		auto t1 = Clock::now();
+		fn(i);
+		auto t2 = Clock::now();
+		samples.push_back(t2-t1);
+	}
+	auto total = Clock::now() - start;
+	printLatency(api, samples, total);
+}
+
+void benchLatency(const Config &cfg) {
+	{
+		FileBackend bk(lineFormat, log4hpp::Level::info, "/dev/null");
+		bk.install();
+		bk.setActive();
+		measureLatency("disabled", cfg.iterations, [](std::size_t i){
+			log::debug("Disabled message {} {}", i, "text");
+		});
+	}
+	{
+		FileBackend bk(lineFormat, log4hpp::Level::debug, "/dev/null");
+		bk.install();
+		bk.setActive();
+		measureLatency("devnull", cfg.iterations, [](std::size_t i){
+			log::debug("Enabled message {} {}", i, "text");
+		});
+		auto ctx1 = log::makeContext("request={}", 42);
+		auto ctx2 = log::makeContext("step={}", "bench");
+		measureLatency("devnull_context", cfg.iterations, [](std::size_t i){
+			log::debug("Enabled message {} {}", i, "text");
+		});
+	}
+	{
+		//the format without time and number - cost of the message itself
+		FileBackend bk("{m}{nl}", log4hpp::Level::debug, "/dev/null");
+		bk.install();
+		bk.setActive();
+		measureLatency("devnull_message_only", cfg.iterations, [](std::size_t i){
+			log::debug("Enabled message {} {}", i, "text");
+		});
+	}
+	{
+		//every write is measured for the latency histogram (default is every 64th)
+		FileBackend bk(lineFormat, log4hpp::Level::debug, "/dev/null");
+		bk.setLatencySampling(1);
+		bk.install();
+		bk.setActive();
+		measureLatency("devnull_measure_every_write", cfg.iterations, [](std::size_t i){
+			log::debug("Enabled message {} {}", i, "text");
+		});
+	}
+	{
+		std::string path = cfg.tmpfs + "/log4hpp-bench.log";
+		{
+			FileBackend bk(lineFormat, log4hpp::Level::debug, path);
+			bk.install();
+			bk.setActive();
+			measureLatency("tmpfs", cfg.iterations, [](std::size_t i){
+				log::debug("Enabled message {} {}", i, "text");
+			});
+		}
+		unlink(path.c_str());
+	}
+}
+
+void benchThreads(const Config &cfg) {
+	FileBackend bk(lineFormat, log4hpp::Level::debug, "/dev/null");
+	bk.install();
+	bk.setActive();
+	std::vector<unsigned int> counts;
+	for (unsigned int n = 1; n < cfg.maxThreads; n = n * 2) counts.push_back(n);
+	counts.push_back(cfg.maxThreads);
+	for (unsigned int n: counts) {
+		std::size_t perThread = cfg.iterations / n;
+		std::atomic<unsigned int> ready = {0};
+		std::atomic<bool> go = {false};
+		std::vector<std::thread> thrs;
+		for (unsigned int t = 0; t < n; t++) {
+			thrs.emplace_back([&]{
+				log::debug("Warm-up");
+				++ready;
+				while (!go.load()) std::this_thread::yield();
+				for (std::size_t i = 0; i < perThread; i++) {
+					log::debug("Threaded message {} {}", i, "text");
+				}
+			});
+		}
+		while (ready.load() < n) std::this_thread::yield();
+		auto start = Clock::now();
+		go = true;
+		for (auto &t: thrs) t.join();
+		auto total = Clock::now() - start;
+		double msgs = static_cast<double>(perThread) * n;
+		std::printf("{\"bench\":\"threads\",\"threads\":%u,\"messages\":%.0f,"
+				"\"msgs_per_sec\":%.0f,\"ns_per_msg\":%.1f}\n",
+				n, msgs, msgs * 1e9 / nanos(total), nanos(total) / msgs);
+	}
+}
+
+template<typename T>
+void measureStringify(const char *name, const std::string_view &format, const T &val, std::size_t iterations) {
+	log4hpp::Buffer buff;
+	auto run = [&]{
+		buff.clear();
+		log4hpp::FormatT<log4hpp::Buffer &, log4hpp::NullMap> fmt(buff);
+		fmt(format, val);
+	};
+	for (std::size_t i = 0; i < iterations/10; i++) run();
+	auto start = Clock::now();
+	for (std::size_t i = 0; i < iterations; i++) run();
+	auto total = Clock::now() - start;
+	std::printf("{\"bench\":\"stringify\",\"type\":\"%s\",\"iterations\":%zu,\"ns_per_op\":%.1f,\"bytes\":%zu}\n",
+			name, iterations, nanos(total)/iterations, buff.size());
+}
+
+void benchStringify(const Config &cfg) {
+	std::string text("Hello \"world\"\n, this is a text of moderate length");
+	std::string binary(256, '\xA5');
+	measureStringify("int", "{}", -1234567, cfg.iterations);
+	measureStringify("unsigned_hex", "{:08X}", 0xDEADBEEFU, cfg.iterations);
+	measureStringify("unsigned_base62", "{:A}", 123456789012UL, cfg.iterations);
+	measureStringify("double", "{}", 3.14159265358979, cfg.iterations);
+	measureStringify("double_fixed", "{:3}", 3.14159265358979, cfg.iterations);
+	measureStringify("bool", "{}", true, cfg.iterations);
+	measureStringify("string", "{}", text, cfg.iterations);
+	measureStringify("string_json", "{:j}", text, cfg.iterations);
+	measureStringify("string_padded", "{:64>}", text, cfg.iterations);
+	measureStringify("string_binary_256", "{:b}", binary, cfg.iterations/10);
+	std::vector<int> vec(100);
+	for (int i = 0; i < 100; i++) vec[i] = i * 1000;
+	measureStringify("vector_int_100", "{:100}", vec, cfg.iterations/10);
+	measureStringify("duration", "{}", std::chrono::microseconds(1500), cfg.iterations);
+	measureStringify("time_point", "{}", std::chrono::system_clock::now(), cfg.iterations);
+}
+
+void benchAlloc(const Config &cfg) {
+	FileBackend bk(lineFormat, log4hpp::Level::debug, "/dev/null");
+	bk.install();
+	bk.setActive();
+	auto run = [&](const char *api, auto &&fn) {
+		for (std::size_t i = 0; i < 1000; i++) fn(i);	//warm-up
+		std::size_t before = log4hpp::AllocAccounting::get().allocations;
+		for (std::size_t i = 0; i < cfg.iterations; i++) fn(i);
+		std::size_t cnt = log4hpp::AllocAccounting::get().allocations - before;
+		std::printf("{\"bench\":\"alloc\",\"api\":\"%s\",\"messages\":%zu,\"allocations\":%zu,\"per_message\":%.4f}\n",
+				api, cfg.iterations, cnt, static_cast<double>(cnt)/cfg.iterations);
+	};
+	run("disabled", [](std::size_t i){log::log(log4hpp::Level::max_verbose, "Disabled {}", i);});
+	run("devnull", [](std::size_t i){log::debug("Enabled message {} {}", i, "text");});
+	run("context", [](std::size_t i){
+		auto ctx = log::makeContext("request={}", i);
+		log::debug("Enabled message {} {}", i, "text");
+	});
+	auto snap = [&]{
+		auto ctx = log::makeContext("request={}", 42);
+		return log::captureContext();
+	}();
+	run("snapshot", [&](std::size_t i){
+		log::ContextSnapshot::Scope _(snap);
+		log::debug("Enabled message {} {}", i, "text");
+	});
+	auto &gctx = log4hpp::GlobalContext::current();
+	gctx.setZeroAllocation(1024);
+	std::thread([&]{
+		run("zero_alloc_mode", [](std::size_t i){
+			log::debug("Enabled message {} {} {}", i, "text", std::string_view("a bit longer text argument"));
+		});
+	}).join();
+	gctx.threadBufferSize = 0;
+	gctx.threadBufferBounded = false;
+}
+
+}
+
+int main(int argc, char **argv) {
+	Config cfg;
+	for (int i = 1; i < argc; i++) {
+		std::string_view a(argv[i]);
+		if (i+1 >= argc) {
+			std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+			return 1;
+		}
+		if (a == "-i") cfg.iterations = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-t") cfg.maxThreads = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-d") cfg.tmpfs = argv[++i];
+		else if (a == "-s") cfg.selection = argv[++i];
+		else {
+			std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+	if (cfg.iterations == 0) cfg.iterations = 1;
+	if (cfg.maxThreads == 0) cfg.maxThreads = 1;
+
+	std::printf("{\"bench\":\"config\",\"iterations\":%zu,\"max_threads\":%u,\"compiler\":\"%s\"}\n",
+			cfg.iterations, cfg.maxThreads, __VERSION__);
+	if (cfg.selected("latency")) benchLatency(cfg);
+	if (cfg.selected("threads")) benchThreads(cfg);
+	if (cfg.selected("stringify")) benchStringify(cfg);
+	if (cfg.selected("alloc")) benchAlloc(cfg);
+	return 0;
+}
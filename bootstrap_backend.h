@@ -0,0 +1,280 @@
+/*
+ * bootstrap_backend.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_BOOTSTRAP_BACKEND_H_
+#define LOG4HPP_BOOTSTRAP_BACKEND_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+
+#include "context.h"
+
+#ifndef LOG4HPP_BOOTSTRAP_SIZE
+#define LOG4HPP_BOOTSTRAP_SIZE (256*1024)
+#endif
+
+namespace log4hpp {
+
+///Backend active before the first backend is installed
+/**
+ * Messages logged before Backend::install() (static initialization, parallel startup) are stored in
+ * a bounded lock-free buffer (LOG4HPP_BOOTSTRAP_SIZE bytes). When a backend is installed, the buffer is
+ * replayed into it, messages which didn't fit are reported by a warning (a message larger than the free
+ * space is dropped, shorter messages logged later are still stored). Threads, which registered
+ * while the bootstrap backend was active, are rebound to the installed backend by their next message.
+ *
+ * The buffer is written to the stderr, when the program crashes before the backend is installed
+ * (CrashHandler)
+ */
+class BootstrapBackend: public IBackend {
+public:
+
+	BootstrapBackend();
+
+	virtual void send(ThreadContext &thr, Level::Type level, const AbstractContext *context, const std::string_view &message) override;
+	virtual void direct_send(const std::string_view &line) override;
+	virtual Level::Type getLevel() const override {return Level::max_verbose;}
+	virtual void crash_dump(int sig) noexcept override;
+	virtual BackendStats getStats() const override;
+
+	///Replays stored messages to the backend and closes the buffer
+	/** Called by Backend::install(), only the first call replays messages */
+	void close(IBackend &target);
+
+	static const std::shared_ptr<BootstrapBackend> &instance() {
+		static std::shared_ptr<BootstrapBackend> inst = std::make_shared<BootstrapBackend>();
+		return inst;
+	}
+
+protected:
+
+	struct Record {
+		///state of the record (written by the writer as the last field)
+		std::atomic<std::uint32_t> ready;
+		///size of the record including the header (aligned)
+		std::uint32_t size;
+		Level::Type level;
+		ThreadId threadId;
+		Timestamp::Tick time;
+		std::uint32_t ctxLen;
+		std::uint32_t msgLen;
+		bool direct;
+
+		const char *ctx() const {return reinterpret_cast<const char *>(this+1);}
+		const char *msg() const {return ctx()+ctxLen;}
+	};
+
+	///Context of the replayed message - levels are separated by the unit separator
+	class ReplayContext: public AbstractContext {
+	public:
+		explicit ReplayContext(const std::string_view &levels):AbstractContext(nullptr),levels(levels) {}
+		virtual void toString(Buffer &out) const override {toStringChain(out, "/", false);}
+		virtual void toStringChain(Buffer &out, const std::string_view &sep, bool reversed) const override;
+	protected:
+		std::string_view levels;
+	};
+
+	enum class Result {stored, dropped, closed};
+
+	///state of the completed record
+	static constexpr std::uint32_t complete = 1;
+
+	static constexpr std::uint64_t closedFlag = std::uint64_t(1) << 63;
+	static constexpr char levelSep = '\x1f';
+
+	std::unique_ptr<std::uint64_t[]> arena;
+	std::size_t capacity;
+	///offset of the next record, closedFlag is set after replay
+	std::atomic<std::uint64_t> head = {0};
+	std::atomic<std::size_t> stored = {0};
+	std::atomic<std::size_t> dropped = {0};
+
+	Result push(const LineInfo &info, Timestamp::Tick time, const std::string_view &ctx, const std::string_view &msg, bool direct);
+	///Reserves space for the record of given size
+	/** @param ofs receives offset of the record */
+	Result reserve(std::size_t sz, std::uint64_t &ofs);
+	///Writes the reserved record and marks it complete
+	void fill(std::uint64_t ofs, const LineInfo &info, Timestamp::Tick time, const std::string_view &ctx, const std::string_view &msg, bool direct);
+	const Record *record(std::uint64_t ofs) const {
+		return reinterpret_cast<const Record *>(reinterpret_cast<const char *>(arena.get())+ofs);
+	}
+	static std::size_t recordSize(std::size_t ctxLen, std::size_t msgLen) {
+		return (sizeof(Record) + ctxLen + msgLen + 7) & ~std::size_t(7);
+	}
+};
+
+inline std::shared_ptr<IBackend> bootstrapBackend() {
+	return BootstrapBackend::instance();
+}
+
+inline BootstrapBackend::BootstrapBackend()
+	:arena(new std::uint64_t[LOG4HPP_BOOTSTRAP_SIZE/8]())
+	,capacity(LOG4HPP_BOOTSTRAP_SIZE/8*8) {}
+
+inline BootstrapBackend::Result BootstrapBackend::reserve(std::size_t sz, std::uint64_t &ofs) {
+	ofs = head.load(std::memory_order_relaxed);
+	do {
+		if (ofs & closedFlag) return Result::closed;
+		//record which doesn't fit doesn't move the head, smaller records can still be stored
+		if (ofs + sz > capacity) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return Result::dropped;
+		}
+	} while (!head.compare_exchange_weak(ofs, ofs + sz, std::memory_order_acquire, std::memory_order_relaxed));
+	return Result::stored;
+}
+
+inline void BootstrapBackend::fill(std::uint64_t ofs, const LineInfo &info, Timestamp::Tick time,
+		const std::string_view &ctx, const std::string_view &msg, bool direct) {
+	char *p = reinterpret_cast<char *>(arena.get())+ofs;
+	Record *r = reinterpret_cast<Record *>(p);
+	r->size = static_cast<std::uint32_t>(recordSize(ctx.size(), msg.size()));
+	r->level = info.level;
+	r->threadId = info.threadId;
+	r->time = time;
+	r->ctxLen = static_cast<std::uint32_t>(ctx.size());
+	r->msgLen = static_cast<std::uint32_t>(msg.size());
+	r->direct = direct;
+	std::copy(ctx.begin(), ctx.end(), p+sizeof(Record));
+	std::copy(msg.begin(), msg.end(), p+sizeof(Record)+ctx.size());
+	r->ready.store(complete, std::memory_order_release);
+	stored.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline BootstrapBackend::Result BootstrapBackend::push(const LineInfo &info, Timestamp::Tick time,
+		const std::string_view &ctx, const std::string_view &msg, bool direct) {
+	std::uint64_t ofs;
+	Result res = reserve(recordSize(ctx.size(), msg.size()), ofs);
+	if (res == Result::stored) fill(ofs, info, time, ctx, msg, direct);
+	return res;
+}
+
+inline void BootstrapBackend::send(ThreadContext &thr, Level::Type level, const AbstractContext *context, const std::string_view &message) {
+	if (!(head.load(std::memory_order_acquire) & closedFlag)) {
+		Buffer &ctx = thr.fmt_buffer;
+		ctx.clear();
+		if (context) {
+			context->walk([&](const AbstractContext *c){
+				c->toStringChain(ctx, std::string_view(&levelSep, 1), false);
+				if (c != context) ctx.push_back(levelSep);
+			});
+		}
+		if (push(LineInfo{level, thr.threadId}, thr.time, ctx, message, false) != Result::closed) return;
+	}
+	//a backend is installed - rebind the thread (the instance() keeps this object alive)
+	auto bk = std::atomic_load(&GlobalContext::current().backend);
+	if (bk.get() == this) return;
+	thr.backend = bk;
+	thr.level = bk->getLevel();
+	bk->send(thr, level, context, message);
+}
+
+inline void BootstrapBackend::direct_send(const std::string_view &line) {
+	if (push(LineInfo(), 0, std::string_view(), line, true) != Result::closed) return;
+	auto bk = std::atomic_load(&GlobalContext::current().backend);
+	if (bk.get() != this) bk->direct_send(line);
+}
+
+inline void BootstrapBackend::close(IBackend &target) {
+	//writers which reserved space before this point are replayed, later writers see the flag
+	std::uint64_t end = head.fetch_or(closedFlag, std::memory_order_acq_rel);
+	if (end & closedFlag) return;
+	ThreadContext &thr = ThreadContext::current();
+	ThreadId tid = thr.threadId;
+	Timestamp::Tick tm = thr.time;
+	std::uint64_t ofs = 0;
+	while (ofs + sizeof(Record) <= end) {
+		const Record *r = record(ofs);
+		//writer could be preempted between reservation and completion
+		while (r->ready.load(std::memory_order_acquire) != complete) std::this_thread::yield();
+		std::string_view msg(r->msg(), r->msgLen);
+		if (r->direct) {
+			target.direct_send(msg);
+		} else {
+			ReplayContext ctx(std::string_view(r->ctx(), r->ctxLen));
+			thr.threadId = r->threadId;
+			thr.time = r->time;
+			target.send(thr, r->level, r->ctxLen?&ctx:nullptr, msg);
+		}
+		ofs += r->size;
+	}
+	thr.threadId = tid;
+	thr.time = Timestamp::now();
+	std::size_t lost = dropped.load(std::memory_order_relaxed);
+	if (lost) {
+		thr.buffer.clear();
+		FormatT<Buffer &, NullMap> fmt(thr.buffer);
+		fmt("log4hpp: {} messages logged before the backend was installed were dropped (bootstrap buffer is full)", lost);
+		target.send(thr, Level::warning, nullptr, thr.buffer);
+	}
+	thr.time = tm;
+}
+
+inline void BootstrapBackend::crash_dump(int) noexcept {
+	std::uint64_t end = head.load(std::memory_order_acquire);
+	if (end & closedFlag) return;
+	std::uint64_t ofs = 0;
+	while (ofs + sizeof(Record) <= end) {
+		const Record *r = record(ofs);
+		if (r->ready.load(std::memory_order_acquire) != complete) break;
+		std::size_t p = 0;
+		while (p < r->msgLen) {
+			auto s = ::write(STDERR_FILENO, r->msg()+p, r->msgLen-p);
+			if (s <= 0) return;
+			p+=s;
+		}
+		if (!r->direct && ::write(STDERR_FILENO, "\n", 1) <= 0) return;
+		ofs += r->size;
+	}
+	//message which was being formatted by the crashing thread
+	ThreadContext *thr = ThreadContext::peek();
+	if (thr && thr->buffer.size()) {
+		std::string_view msg = thr->buffer;
+		if (::write(STDERR_FILENO, msg.data(), msg.size()) > 0) {
+			if (::write(STDERR_FILENO, "\n", 1) <= 0) return;
+		}
+	}
+}
+
+inline BackendStats BootstrapBackend::getStats() const {
+	BackendStats st;
+	st.accepted = stored.load(std::memory_order_relaxed);
+	st.dropped = dropped.load(std::memory_order_relaxed);
+	GlobalContext &gc = GlobalContext::current();
+	st.threads = gc.threadCount.load(std::memory_order_relaxed);
+	st.thread_memory = gc.threadMemory.load(std::memory_order_relaxed);
+	st.filtered += gc.filteredMessages();
+	return st;
+}
+
+inline void BootstrapBackend::ReplayContext::toStringChain(Buffer &out, const std::string_view &sep, bool reversed) const {
+	std::string_view rest = levels;
+	std::size_t n = 0;
+	while (!rest.empty()) {
+		std::size_t p = reversed?rest.rfind(levelSep):rest.find(levelSep);
+		std::string_view lv;
+		if (p == rest.npos) {
+			lv = rest;
+			rest = std::string_view();
+		} else if (reversed) {
+			lv = rest.substr(p+1);
+			rest = rest.substr(0, p);
+		} else {
+			lv = rest.substr(0, p);
+			rest = rest.substr(p+1);
+		}
+		if (n++) out.append(sep);
+		out.append(lv);
+	}
+}
+
+}
+
+#endif /* LOG4HPP_BOOTSTRAP_BACKEND_H_ */
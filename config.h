@@ -0,0 +1,36 @@
+/*
+ * config.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_CONFIG_H_
+#define LOG4HPP_CONFIG_H_
+
+///Compiled mode
+/**
+ * By default the library is header-only. When LOG4HPP_COMPILED is defined (in all translation units),
+ * the formatting core, the appenders and the backends of the common appenders are compiled only once in
+ * the static library log4hpp_compiled (log4hpp.cpp, which defines LOG4HPP_COMPILED_LIBRARY). The call
+ * sites only capture arguments.
+ *
+ * LOG4HPP_IMPL - prefix of the out-of-line definitions (inline in the header-only mode)
+ * LOG4HPP_WITH_IMPL - defined, when the out-of-line definitions are compiled in this translation unit
+ * LOG4HPP_EXTERN - prefix of the explicit instantiations (extern outside of the library)
+ */
+#ifdef LOG4HPP_COMPILED
+#ifdef LOG4HPP_COMPILED_LIBRARY
+#define LOG4HPP_IMPL
+#define LOG4HPP_WITH_IMPL 1
+#define LOG4HPP_EXTERN
+#else
+#define LOG4HPP_IMPL
+#define LOG4HPP_EXTERN extern
+#endif
+#else
+#define LOG4HPP_IMPL inline
+#define LOG4HPP_WITH_IMPL 1
+#endif
+
+#endif /* LOG4HPP_CONFIG_H_ */
@@ -8,51 +8,161 @@
 #ifndef LOG4HPP_CONTEXT_H_
 #define LOG4HPP_CONTEXT_H_
 
+#include <algorithm>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
 #include <tuple>
 #include <vector>
 
+#include "alloc_accounting.h"
+#include "config.h"
 #include "format.h"
 #include "backend.h"
 
 #include "level.h"
+#include "timestamp.h"
 namespace log4hpp {
 
 class Buffer {
 public:
 
-	void operator()(char c) {_data.push_back(c);}
-	void clear() {_data.clear();}
+	void operator()(char c) {
+		if (_data.size() < _limit) _data.push_back(c);
+		else _overflow = true;
+	}
+	void clear() {_data.clear();_overflow = false;}
 	auto data() {return _data.data();}
 	std::size_t size() const {return _data.size();}
-	void resize(std::size_t sz) {_data.resize(sz);}
-	void push_back(char c) {_data.push_back(c);}
-	void append(const std::string_view &txt) {for (char c: txt) _data.push_back(c);}
-	void append(const char *c, std::size_t sz) {for (std::size_t i = 0; i < sz; i++) _data.push_back(c[i]);}
+	///Resizes the buffer, the bounded buffer is not resized above its capacity
+	void resize(std::size_t sz) {
+		if (sz > _limit) {
+			sz = _limit;
+			_overflow = true;
+		}
+		_data.resize(sz);
+	}
+	void push_back(char c) {operator()(c);}
+	void append(const std::string_view &txt) {append(txt.data(), txt.size());}
+	void append(const char *c, std::size_t sz) {
+		std::size_t sp = _data.size() < _limit?_limit - _data.size():0;
+		if (sz > sp) {
+			sz = sp;
+			_overflow = true;
+		}
+		_data.insert(_data.end(), c, c + sz);
+	}
 	operator std::string_view() const {return std::string_view(_data.data(), _data.size());}
 
+	///Returns true, if characters were discarded, because the bounded buffer is full
+	bool overflow() const {return _overflow;}
+
+	///Replaces end of the content by the text, so the text fits to the bounded buffer
+	/** Used to keep the truncation mark and the line terminator of a truncated line */
+	void replaceTail(const std::string_view &txt) {
+		std::size_t room = _limit > txt.size()?_limit - txt.size():0;
+		if (_data.size() > room) _data.resize(room);
+		_data.insert(_data.end(), txt.data(), txt.data() + std::min(txt.size(), _limit));
+	}
+
+	///Preallocates the buffer
+	/**
+	 * @param capacity capacity in bytes
+	 * @param bounded if true, the buffer never grows above the capacity, characters above
+	 * the capacity are discarded
+	 */
+	void reserve(std::size_t capacity, bool bounded) {
+		_data.reserve(capacity);
+		_base = capacity;
+		_limit = bounded?capacity:static_cast<std::size_t>(-1);
+	}
+
+	///Returns allocated capacity
+	std::size_t capacity() const {return _data.capacity();}
+
+	///Releases memory above the given capacity (content is discarded)
+	/** The buffer never shrinks below the reserved capacity */
+	void trim(std::size_t maxCapacity) {
+		if (_data.capacity() > maxCapacity && _data.capacity() > _base) {
+			std::vector<char> n;
+			n.reserve(_base);
+			_data.swap(n);
+		}
+	}
+
 protected:
 	std::vector<char> _data;
+	std::size_t _limit = static_cast<std::size_t>(-1);
+	std::size_t _base = 0;
+	bool _overflow = false;
 };
 
 template<> class Stringify<Buffer>: public StringifyString {};
 
+///Returns backend, which buffers messages until a backend is installed (bootstrap_backend.h)
+inline std::shared_ptr<IBackend> bootstrapBackend();
+
+struct ThreadContext;
+
 struct GlobalContext {
 	///Thread identifier (each new thread allocates new ID)
 	std::atomic<unsigned int> threadCounter;
-	///current backend
+	///current backend (access by std::atomic_load/std::atomic_store)
+	/** Until a backend is installed, the bootstrap backend is used */
 	std::shared_ptr<IBackend> backend;
+	///capacity reserved for each buffer of the thread, when the thread registers (0 - grow on demand)
+	std::size_t threadBufferSize = 0;
+	///if true, buffers of the thread never grow above threadBufferSize, longer texts are truncated
+	bool threadBufferBounded = false;
+	///maximum size of formatted message in bytes (0 - unlimited)
+	/** Formatting stops at the limit, the message is marked by "...[truncated: N bytes]" */
+	std::atomic<std::size_t> maxMessageSize = {0};
+	///maximum size of each formatted argument of the message in bytes (0 - unlimited)
+	std::atomic<std::size_t> maxArgumentSize = {0};
+	///memory budget of buffers of each thread in bytes (0 - unlimited)
+	/** When buffers grow above the budget (an oversized message), they are released after
+	 * the message is logged. Buffers reserved by threadBufferSize are kept */
+	std::atomic<std::size_t> threadMemoryBudget = {0};
+	///memory allocated by buffers of all threads
+	std::atomic<std::size_t> threadMemory = {0};
+	///count of threads, which have logging state
+	std::atomic<std::size_t> threadCount = {0};
+
+	///Returns count of messages rejected by the level of the thread (all threads)
+	std::size_t filteredMessages();
 
 	static GlobalContext& current() {
 		static GlobalContext st;
 		return st;
 	}
 
-	GlobalContext() {}
+	///Enables zero-allocation mode
+	/**
+	 * Each thread preallocates its buffers when it logs for the first time, then the logging
+	 * doesn't allocate (as long as the contexts and the appender don't allocate). Longer
+	 * messages and lines are truncated and marked, the line keeps its terminator. Must be
+	 * called before other threads start to log
+	 *
+	 * @param bufferSize maximum size of formatted message (the buffer for the final line
+	 * is four times larger)
+	 */
+	void setZeroAllocation(std::size_t bufferSize) {
+		threadBufferSize = bufferSize;
+		threadBufferBounded = true;
+	}
+
+	GlobalContext():backend(bootstrapBackend()) {}
 	GlobalContext(const GlobalContext &) = delete;
 	GlobalContext &operator=(const GlobalContext &) = delete;
 
+protected:
+	///registered threads (for the statistics)
+	std::mutex threadsLock;
+	ThreadContext *threads = nullptr;
+	///messages filtered by threads which already exited
+	std::size_t exitedFiltered = 0;
+
+	friend struct ThreadContext;
 };
 
 
@@ -64,6 +174,8 @@ using LevelTransformFn = Level::Type (*)(Level::Type, void *);
 struct ThreadContext {
 	///current loggin level for thread
 	Level::Type level;
+	///level granted by level transforms of active contexts (overrides the level of the backend)
+	Level::Type ctxLevel = Level::nolevel;
 	///current thread id
 	unsigned int threadId;
 	///buffer for formatting message before it is send to the backend
@@ -77,45 +189,211 @@ struct ThreadContext {
 	///current backend
 	std::shared_ptr<IBackend> backend;
 
-
-	ThreadContext(GlobalContext &st){
-		level = st.backend->getLevel();
+	///message numbering state - next number (used by the backend)
+	std::size_t seqNext = 0;
+	///message numbering state - end of reserved block
+	std::size_t seqEnd = 0;
+	///message numbering state - backend which owns the state
+	const void *seqOwner = nullptr;
+	///time of the current message - captured at the call site
+	Timestamp::Tick time = 0;
+	///count of messages rejected by the level of the thread (written only by the thread)
+	std::atomic<std::size_t> filtered = {0};
+
+
+	ThreadContext(GlobalContext &st):global(st) {
+		backend = std::atomic_load(&st.backend);
+		level = backend->getLevel();
 		threadId = st.threadCounter++;
-		backend = st.backend;	}
+		if (st.threadBufferSize) {
+			buffer.reserve(st.threadBufferSize, st.threadBufferBounded);
+			//final line contains the message, the context and other fields
+			bk_buffer.reserve(st.threadBufferSize*4, st.threadBufferBounded);
+			fmt_buffer.reserve(st.threadBufferSize, st.threadBufferBounded);
+		}
+		++st.threadCount;
+		updateMemory(st);
+		{
+			std::lock_guard _(st.threadsLock);
+			nextThread = st.threads;
+			if (nextThread) nextThread->prevThread = this;
+			st.threads = this;
+		}
+		instance() = this;
+	}
+
+	~ThreadContext() {
+		instance() = nullptr;
+		GlobalContext &st = global;
+		{
+			std::lock_guard _(st.threadsLock);
+			if (prevThread) prevThread->nextThread = nextThread;
+			else st.threads = nextThread;
+			if (nextThread) nextThread->prevThread = prevThread;
+			st.exitedFiltered += filtered.load(std::memory_order_relaxed);
+		}
+		st.threadMemory.fetch_sub(memory, std::memory_order_relaxed);
+		--st.threadCount;
+	}
+
+	///Counts message rejected by the level of the thread
+	/** Only the owning thread writes the counter, so the increment needs no locked instruction */
+	void countFiltered() {
+		filtered.store(filtered.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+	}
+
+	///Called after a message is logged - releases the message, applies the memory budget
+	void trimBuffers() {
+		//an empty buffer means that no message is in progress (crash handler)
+		buffer.clear();
+		std::size_t cap = buffer.capacity() + bk_buffer.capacity() + fmt_buffer.capacity();
+		GlobalContext &st = global;
+		std::size_t budget = st.threadMemoryBudget.load(std::memory_order_relaxed);
+		//nothing has grown and the buffers are within the budget (which can be set at runtime)
+		if (cap == memory && (!budget || cap <= budget)) return;
+		if (budget && cap > budget) {
+			//the final line needs the most space
+			buffer.trim(budget/4);
+			fmt_buffer.trim(budget/4);
+			bk_buffer.trim(budget/2);
+		}
+		updateMemory(st);
+	}
 
 	static ThreadContext &current() {
 		thread_local ThreadContext th(GlobalContext::current());
 		return th;
 	}
 
+	///Returns context of the current thread, doesn't create it - async-signal-safe
+	/** @return context or nullptr, if the thread has not logged yet */
+	static ThreadContext *peek() {
+		return instance();
+	}
+
 	ThreadContext(const ThreadContext &) = delete;
 	ThreadContext &operator=(const ThreadContext &) = delete;
 
 	Level::Type transform(Level::Type level) const;
 
+protected:
+	///global context (avoids the check of the static initialization on each message)
+	GlobalContext &global;
+	///memory allocated by buffers (reported to the global context)
+	std::size_t memory = 0;
+
+	///list of registered threads (GlobalContext::threads)
+	ThreadContext *prevThread = nullptr;
+	ThreadContext *nextThread = nullptr;
+
+	static ThreadContext *&instance() {
+		static thread_local ThreadContext *ptr = nullptr;
+		return ptr;
+	}
+
+	friend struct GlobalContext;
+
+	void updateMemory(GlobalContext &st) {
+		std::size_t cap = buffer.capacity() + bk_buffer.capacity() + fmt_buffer.capacity();
+		if (cap > memory) st.threadMemory.fetch_add(cap - memory, std::memory_order_relaxed);
+		else st.threadMemory.fetch_sub(memory - cap, std::memory_order_relaxed);
+		memory = cap;
+	}
 };
 
 
 
+inline std::size_t GlobalContext::filteredMessages() {
+	std::lock_guard _(threadsLock);
+	std::size_t sum = exitedFiltered;
+	for (ThreadContext *t = threads; t; t = t->nextThread) sum += t->filtered.load(std::memory_order_relaxed);
+	return sum;
+}
+
+///Formats message with type-erased arguments (compiled mode)
+LOG4HPP_IMPL void vformatMessage(ThreadContext &thr, const std::string_view &msg, const _details::ArgList<Buffer> &args);
+
+///Formats message to the buffer of the thread, applies size limits
+template<typename ... Args>
+inline void formatMessage(ThreadContext &thr, const std::string_view &msg, const Args & ... args) {
+#ifdef LOG4HPP_COMPILED
+	//only the arguments are captured, formatting is compiled in the library
+	const _details::FormatArg<Buffer> list[sizeof...(Args)+1] = {_details::FormatArg<Buffer>(args)...};
+	vformatMessage(thr, msg, _details::ArgList<Buffer>{list, sizeof...(Args)});
+#else
+	GlobalContext &gc = GlobalContext::current();
+	std::size_t msgLimit = gc.maxMessageSize.load(std::memory_order_relaxed);
+	std::size_t argLimit = gc.maxArgumentSize.load(std::memory_order_relaxed);
+	thr.buffer.clear();
+	if (msgLimit == 0 && argLimit == 0) {
+		FormatT<Buffer &,NullMap> fmt(thr.buffer);
+		fmt(msg, args...);
+	} else {
+		LimitedOut<Buffer> out(thr.buffer, msgLimit?msgLimit:static_cast<std::size_t>(-1));
+		FormatT<LimitedOut<Buffer> &,NullMap> fmt(out);
+		if (argLimit) fmt.setArgumentLimit(argLimit);
+		fmt(msg, args...);
+		if (out.truncated()) _details::writeTruncated(thr.buffer, out.total());
+	}
+	//the message doesn't fit to the bounded buffer
+	if (thr.buffer.overflow()) thr.buffer.replaceTail("...[truncated]");
+#endif
+}
+
+#ifdef LOG4HPP_WITH_IMPL
+LOG4HPP_IMPL void vformatMessage(ThreadContext &thr, const std::string_view &msg, const _details::ArgList<Buffer> &args) {
+	GlobalContext &gc = GlobalContext::current();
+	std::size_t msgLimit = gc.maxMessageSize.load(std::memory_order_relaxed);
+	std::size_t argLimit = gc.maxArgumentSize.load(std::memory_order_relaxed);
+	thr.buffer.clear();
+	LimitedOut<Buffer> out(thr.buffer, msgLimit?msgLimit:static_cast<std::size_t>(-1));
+	FormatT<LimitedOut<Buffer> &,NullMap> fmt(out);
+	if (argLimit) fmt.setArgumentLimit(argLimit);
+	fmt(msg, args);
+	if (out.truncated()) _details::writeTruncated(thr.buffer, out.total());
+	if (thr.buffer.overflow()) thr.buffer.replaceTail("...[truncated]");
+}
+#endif
+
+
 class IContext {
 public:
 	virtual ~IContext() {}
 	///Appends context description to the output string
 	/** function must not clear the buffer */
 	virtual void toString(Buffer &out) const = 0;
+	///Appends context description, contexts which carry more levels separate them by the separator
+	/**
+	 * @param out output buffer
+	 * @param sep separator between levels
+	 * @param reversed levels are rendered in reversed order (innermost first)
+	 *
+	 * Default implementation expects single level context, it calls toString()
+	 */
+	virtual void toStringChain(Buffer &out, const std::string_view &, bool) const {
+		toString(out);
+	}
 
 };
 
 class Attach;
+class ContextSnapshot;
 
 ///Abstract context must be instancied at stack;
 class AbstractContext: public IContext {
 public:
 
 
+	///Creates context and links it to the thread
+	/**
+	 * @param ctx thread context. Can be nullptr, which creates detached context, use Attach to
+	 * activate such context
+	 */
 	explicit AbstractContext(ThreadContext *ctx):current(ctx) {
-		prevContext = current->curCtx;
-		current->curCtx = this;
+		if (current) {
+			prevContext = current->curCtx;
+			current->curCtx = this;
+		}
 	}
 
 	AbstractContext():AbstractContext(&ThreadContext::current()) {}
@@ -125,6 +403,7 @@ public:
 
 	virtual ~AbstractContext() {
 		if (current) {
+			restoreLevel();
 			current->curCtx = prevContext;
 		}
 	}
@@ -133,6 +412,41 @@ public:
 		if (level < current->level) current->level = level;
 	}
 
+	///Sets level transformation, which is active while the context is attached
+	/**
+	 * The function receives the level of the thread and returns the level used while
+	 * the context is active. The previous level is restored when the context is destroyed
+	 * or detached. When the transformation makes the level more verbose, such messages
+	 * also pass the level of the backend.
+	 *
+	 * Call it before nested contexts are created. The transformation is also captured by
+	 * ContextSnapshot and applied on the thread, where the snapshot is activated, so the pointer
+	 * must stay valid as long as any snapshot exists.
+	 *
+	 * @param fn transformation function (nullptr to remove transformation)
+	 * @param ptr user pointer passed to the function
+	 */
+	void setLevelTransform(LevelTransformFn fn, void *ptr) {
+		restoreLevel();
+		trnfn = fn;
+		trnptr = ptr;
+		applyLevel();
+	}
+
+	///Makes logging more verbose while the context is active
+	/**
+	 * @code
+	 * RequestContext ctx(req.id);
+	 * if (traced.count(req.id)) ctx.setScopedLevel(Level::debug);
+	 * @endcode
+	 */
+	void setScopedLevel(Level::Type level) {
+		//the level is carried in the user pointer, so the transform can outlive the context (snapshots)
+		setLevelTransform([](Level::Type t, void *ptr) {
+			return std::max(t, static_cast<Level::Type>(reinterpret_cast<std::uintptr_t>(ptr)));
+		}, reinterpret_cast<void *>(static_cast<std::uintptr_t>(level)));
+	}
+
 
 	const AbstractContext *getPrevContext() const {return prevContext;}
 	template<typename Fn>
@@ -145,41 +459,59 @@ public:
 
 	template<typename ... Args>
 	inline void log(Level::Type level, const std::string_view &msg, const Args & ... args) {
+		if (!Level::isCompiled(level)) return;
 		if (current->level >= level) {
-			current->buffer.clear();
-			FormatT<Buffer &,NullMap> fmt(current->buffer);
-			fmt(msg, args...);
+			current->time = Timestamp::now();
+			LOG4HPP_ALLOC_SCOPE;
+			formatMessage(*current, msg, args...);
 			current->backend->send(*current, level, this, current->buffer);
+			current->trimBuffers();
+		} else {
+			current->countFiltered();
 		}
 	}
 
 	template<typename ... Args>
 	inline void debug(const std::string_view &msg, const Args & ... args) {
-		log(Level::debug, msg, args...);
+		if constexpr(Level::isCompiled(Level::debug)) {
+			log(Level::debug, msg, args...);
+		}
 	}
 	template<typename ... Args>
 	inline void info(const std::string_view &msg, const Args & ... args) {
-		log(Level::info, msg, args...);
+		if constexpr(Level::isCompiled(Level::info)) {
+			log(Level::info, msg, args...);
+		}
 	}
 	template<typename ... Args>
 	inline void note(const std::string_view &msg, const Args & ... args) {
-		log(Level::note, msg, args...);
+		if constexpr(Level::isCompiled(Level::note)) {
+			log(Level::note, msg, args...);
+		}
 	}
 	template<typename ... Args>
 	inline void progress(const std::string_view &msg, const Args & ... args) {
-		log(Level::progress, msg, args...);
+		if constexpr(Level::isCompiled(Level::progress)) {
+			log(Level::progress, msg, args...);
+		}
 	}
 	template<typename ... Args>
 	inline void warning(const std::string_view &msg, const Args & ... args) {
-		log(Level::warning, msg, args...);
+		if constexpr(Level::isCompiled(Level::warning)) {
+			log(Level::warning, msg, args...);
+		}
 	}
 	template<typename ... Args>
 	inline void error(const std::string_view &msg, const Args & ... args) {
-		log(Level::error, msg, args...);
+		if constexpr(Level::isCompiled(Level::error)) {
+			log(Level::error, msg, args...);
+		}
 	}
 	template<typename ... Args>
 	inline void fatal(const std::string_view &msg, const Args & ... args) {
-		log(Level::fatal, msg, args...);
+		if constexpr(Level::isCompiled(Level::fatal)) {
+			log(Level::fatal, msg, args...);
+		}
 	}
 
 protected:
@@ -189,9 +521,41 @@ protected:
 	ThreadContext *current = nullptr;
 	LevelTransformFn trnfn = nullptr;
 	void *trnptr = nullptr;
+	///levels of the thread before the transformation was applied
+	Level::Type savedLevel = Level::nolevel;
+	Level::Type savedCtxLevel = Level::nolevel;
+	///levels set by the transformation
+	Level::Type appliedLevel = Level::nolevel;
+	Level::Type appliedCtxLevel = Level::nolevel;
+	bool levelApplied = false;
+
+	void applyLevel() {
+		if (current && trnfn) {
+			savedLevel = current->level;
+			savedCtxLevel = current->ctxLevel;
+			current->level = trnfn(savedLevel, trnptr);
+			if (current->level > savedLevel && current->level > current->ctxLevel) {
+				current->ctxLevel = current->level;
+			}
+			appliedLevel = current->level;
+			appliedCtxLevel = current->ctxLevel;
+			levelApplied = true;
+		}
+	}
+
+	///Reverts the change made by the transformation
+	/** Levels changed meanwhile by setLevel() or by activation of a backend are kept */
+	void restoreLevel() {
+		if (levelApplied) {
+			if (current->level == appliedLevel) current->level = savedLevel;
+			if (current->ctxLevel == appliedCtxLevel) current->ctxLevel = savedCtxLevel;
+			levelApplied = false;
+		}
+	}
 
 	void detach() {
 		if (current) {
+			restoreLevel();
 			current->curCtx = prevContext;
 			current = nullptr;
 			prevContext = nullptr;
@@ -203,14 +567,69 @@ protected:
 		current = ctx;
 		prevContext = current->curCtx;
 		current->curCtx = this;
+		applyLevel();
 	}
 
 	void attach() {
 		attach(&ThreadContext::current());
 	}
 
+	///Detaches this context and all contexts stacked on it
+	/**
+	 * @return innermost context of the detached chain, pass it to attachChain()
+	 */
+	AbstractContext *detachChain() {
+		if (!current) return nullptr;
+		AbstractContext *top = current->curCtx;
+		//the context must be in the chain of the thread
+		for (AbstractContext *c = top; c != this; c = c->prevContext) {
+			if (c == nullptr) {
+				//broken chain (contexts were not destroyed in reverse order), leave it as is
+				restoreLevel();
+				current = nullptr;
+				prevContext = nullptr;
+				return this;
+			}
+		}
+		ThreadContext *thr = current;
+		//levels are restored in reverse order of application, links inside of the chain are kept
+		for (AbstractContext *c = top; c != this; c = c->prevContext) {
+			c->restoreLevel();
+			c->current = nullptr;
+		}
+		restoreLevel();
+		thr->curCtx = prevContext;
+		current = nullptr;
+		prevContext = nullptr;
+		return top;
+	}
+
+	///Attaches the chain detached by detachChain() to the current thread
+	void attachChain(AbstractContext *top) {
+		if (top == nullptr || top == this) {
+			attach();
+			return;
+		}
+		detachChain();
+		ThreadContext *thr = &ThreadContext::current();
+		prevContext = thr->curCtx;
+		top->attachLinked(this, thr);
+		thr->curCtx = top;
+	}
+
+	///Attaches contexts from the bottom of the chain to this context
+	void attachLinked(AbstractContext *bottom, ThreadContext *thr) {
+		if (this != bottom) prevContext->attachLinked(bottom, thr);
+		current = thr;
+		applyLevel();
+	}
+
+	///Returns snapshot carried by this context, if any (allows to share the snapshot without copying)
+	virtual const ContextSnapshot *getSnapshot() const {return nullptr;}
+
 	friend class Attach;
 	friend struct ThreadContext;
+	friend class ContextSnapshot;
 
 };
 
@@ -242,13 +661,15 @@ inline Level::Type ThreadContext::transform(Level::Type t) const {
 
 
 template<typename StrType, typename ... Args>
-class FmtContext {
+class FmtContext: public AbstractContext {
 public:
-	FmtContext(ThreadContext *ctx, StrType &&format, Args && ... args)
-			:str(std::forward<StrType>(format))
-			,args(std::forward<Args>(args)...) {}
+	template<typename ... Xs>
+	FmtContext(ThreadContext *ctx, const std::string_view &format, Xs && ... args)
+			:AbstractContext(ctx)
+			,str(format)
+			,args(std::forward<Xs>(args)...) {}
 
-	virtual void toString(Buffer &out) {
+	virtual void toString(Buffer &out) const override {
 		FormatT<Buffer &, NullMap> fmt(out);
 		std::apply([&](const auto &... args ){
 			fmt(str, args...);
@@ -270,13 +691,32 @@ template<typename ... Args>
 auto makeDetachedContext(const std::string_view &format, const Args & ... args) {
 	return FmtContext<std::string, Args ...>(nullptr, format, args...);
 }
+///Creates detached context, which doesn't copy the format string (doesn't allocate)
+/** The format must be a string literal (or it must outlive the context). Arguments are copied */
+template<typename ... Args>
+auto makeStaticDetachedContext(const std::string_view &format, const Args & ... args) {
+	return FmtContext<std::string_view, Args ...>(nullptr, format, args...);
+}
 
 inline Buffer &getTmpBuffer() {
 	return ThreadContext::current().buffer;
 }
 
-}
+#ifdef LOG4HPP_COMPILED
+//stringify functions of common types are compiled in the library
+LOG4HPP_EXTERN template void StringifyString::operator()(const std::string_view &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifyUnsigned::operator()(const unsigned char &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifyUnsigned::operator()(const unsigned int &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifyUnsigned::operator()(const unsigned long &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifyUnsigned::operator()(const unsigned long long &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifySigned::operator()(const int &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifySigned::operator()(const long &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifySigned::operator()(const long long &, const std::string_view &, LimitedOut<Buffer> &);
+LOG4HPP_EXTERN template void StringifyReal::operator()(double, const std::string_view &, LimitedOut<Buffer> &);
+#endif
 
+}
 
+#include "bootstrap_backend.h"
 
 #endif /* LOG4HPP_CONTEXT_H_ */
@@ -0,0 +1,308 @@
+/*
+ * context_snapshot.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_CONTEXT_SNAPSHOT_H_
+#define LOG4HPP_CONTEXT_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "context.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
+namespace log4hpp {
+
+///Immutable reference counted snapshot of the context chain
+/**
+ * The snapshot is captured once (the context chain is rendered into single memory block) and then
+ * can be passed to an another thread, task or coroutine. Copying the snapshot only increases the
+ * reference counter. To activate the snapshot, create instance of ContextSnapshot::Scope on the stack.
+ * Activation doesn't allocate any memory.
+ *
+ * @code
+ * auto snap = log::captureContext();
+ * pool.run([snap]{
+ *     ContextSnapshot::Scope _(snap);
+ *     log::info("Running in the pool");
+ * });
+ * @endcode
+ *
+ * Capturing context while only an activated snapshot is active returns the same snapshot, so
+ * further propagation doesn't allocate either.
+ *
+ * Level transformations of the captured contexts (setScopedLevel(), setLevelTransform()) are
+ * captured as well. They are applied to the level of the thread, where the snapshot is activated.
+ */
+class ContextSnapshot {
+public:
+
+	class Scope;
+
+	ContextSnapshot() = default;
+	ContextSnapshot(const ContextSnapshot &other):blk(other.blk) {addRef();}
+	ContextSnapshot(ContextSnapshot &&other):blk(other.blk) {other.blk = nullptr;}
+	ContextSnapshot &operator=(const ContextSnapshot &other) {
+		if (blk != other.blk) {
+			release();
+			blk = other.blk;
+			addRef();
+		}
+		return *this;
+	}
+	ContextSnapshot &operator=(ContextSnapshot &&other) {
+		if (this != &other) {
+			release();
+			blk = other.blk;
+			other.blk = nullptr;
+		}
+		return *this;
+	}
+	~ContextSnapshot() {release();}
+
+	///Captures context chain active on the current thread
+	static ContextSnapshot capture() {
+		auto &thr = ThreadContext::current();
+		return capture(thr.curCtx, thr.fmt_buffer);
+	}
+
+	///Captures context chain
+	/**
+	 * @param ctx the innermost context of the chain
+	 * @param tmp temporary buffer
+	 * @return snapshot
+	 */
+	static ContextSnapshot capture(const AbstractContext *ctx, Buffer &tmp);
+
+	///Returns true, if the snapshot is empty (no context was active)
+	bool empty() const {return blk == nullptr;}
+
+	///Returns count of levels
+	unsigned int levels() const {return blk?blk->count:0;}
+
+	///Returns text of the level
+	std::string_view level(unsigned int idx) const {
+		auto ends = blk->ends();
+		std::uint32_t b = idx?ends[idx-1]:0;
+		return std::string_view(blk->text()+b, ends[idx]-b);
+	}
+
+	///Renders snapshot
+	void toString(Buffer &out, const std::string_view &sep, bool reversed) const {
+		auto cnt = levels();
+		for (unsigned int i = 0; i < cnt; i++) {
+			if (i) out.append(sep);
+			out.append(level(reversed?cnt-i-1:i));
+		}
+	}
+
+	bool operator==(const ContextSnapshot &other) const {return blk == other.blk;}
+	bool operator!=(const ContextSnapshot &other) const {return blk != other.blk;}
+
+protected:
+
+	struct Transform {
+		LevelTransformFn fn;
+		void *ptr;
+	};
+
+	struct alignas(Transform) Block {
+		std::atomic<unsigned int> refs;
+		std::uint32_t count;
+		std::uint32_t trcount;
+		Transform *transforms() {return reinterpret_cast<Transform *>(this+1);}
+		const Transform *transforms() const {return reinterpret_cast<const Transform *>(this+1);}
+		std::uint32_t *ends() {return reinterpret_cast<std::uint32_t *>(transforms()+trcount);}
+		const std::uint32_t *ends() const {return reinterpret_cast<const std::uint32_t *>(transforms()+trcount);}
+		const char *text() const {return reinterpret_cast<const char *>(ends()+count);}
+		char *text() {return reinterpret_cast<char *>(ends()+count);}
+	};
+
+	Block *blk = nullptr;
+
+	///Applies captured transformations in order (outermost first), ptr is the Block
+	static Level::Type transformLevel(Level::Type t, void *ptr) {
+		const Block *b = static_cast<const Block *>(ptr);
+		const Transform *tr = b->transforms();
+		for (std::uint32_t i = 0; i < b->trcount; i++) t = tr[i].fn(t, tr[i].ptr);
+		return t;
+	}
+
+	void addRef() {
+		if (blk) blk->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+	void release() {
+		if (blk && blk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			blk->~Block();
+			::operator delete(blk);
+		}
+		blk = nullptr;
+	}
+
+};
+
+///Activates the snapshot on the current thread
+/**
+ * The object must be instancied on the stack (or in the coroutine frame, see bindContext())
+ */
+class ContextSnapshot::Scope: public AbstractContext {
+public:
+	explicit Scope(const ContextSnapshot &snap):Scope(snap, &ThreadContext::current()) {}
+	///Creates scope
+	/**
+	 * @param snap snapshot
+	 * @param thr thread context, can be nullptr to create suspended scope
+	 */
+	Scope(const ContextSnapshot &snap, ThreadContext *thr):AbstractContext(thr),snap(snap) {
+		if (this->snap.blk && this->snap.blk->trcount) {
+			setLevelTransform(&ContextSnapshot::transformLevel, this->snap.blk);
+		}
+	}
+
+	///Detaches the scope from the thread (before the task is suspended)
+	/** Contexts created on the scope (inside of the task) are detached as well */
+	void suspend() {top = detachChain();}
+	///Attaches the scope to the current thread (after the task is resumed)
+	/** Contexts detached by suspend() are attached on the top of the scope again */
+	void resume() {
+		attachChain(top);
+		top = nullptr;
+	}
+
+	virtual void toString(Buffer &out) const override {
+		snap.toString(out, std::string_view(), false);
+	}
+	virtual void toStringChain(Buffer &out, const std::string_view &sep, bool reversed) const override {
+		snap.toString(out, sep, reversed);
+	}
+	virtual const ContextSnapshot *getSnapshot() const override {return &snap;}
+
+protected:
+	ContextSnapshot snap;
+	///innermost context of the suspended chain
+	AbstractContext *top = nullptr;
+};
+
+inline ContextSnapshot ContextSnapshot::capture(const AbstractContext *ctx, Buffer &tmp) {
+	if (ctx == nullptr) return ContextSnapshot();
+	//only activated snapshot - share it
+	if (ctx->getPrevContext() == nullptr && ctx->getSnapshot()
+			&& (ctx->trnfn == nullptr || ctx->trnfn == &transformLevel)) return *ctx->getSnapshot();
+
+	//level transformations - an activated snapshot contributes the transformations it carries
+	std::uint32_t trcount = 0;
+	auto walkTransforms = [&](auto &&fn) {
+		ctx->walk([&](const AbstractContext *c){
+			if (c->trnfn == &transformLevel) {
+				const Block *b = static_cast<const Block *>(c->trnptr);
+				for (std::uint32_t i = 0; i < b->trcount; i++) fn(b->transforms()[i]);
+			} else if (c->trnfn) {
+				fn(Transform{c->trnfn, c->trnptr});
+			}
+		});
+	};
+	walkTransforms([&](const Transform &){++trcount;});
+
+	//levels are rendered one by one to the temporary buffer (it can be bounded), the first pass
+	//measures the levels, the second pass copies them to the block. A level which doesn't fit
+	//to the bounded buffer is truncated
+	auto walkLevels = [&](auto &&fn) {
+		ctx->walk([&](const AbstractContext *c){
+			auto s = c->getSnapshot();
+			if (s) {
+				for (unsigned int i = 0, cnt = s->levels(); i < cnt; i++) fn(s->level(i));
+			} else {
+				tmp.clear();
+				c->toString(tmp);
+				fn(std::string_view(tmp));
+			}
+		});
+	};
+	std::uint32_t count = 0;
+	std::size_t textsz = 0;
+	walkLevels([&](std::string_view txt){
+		++count;
+		textsz += txt.size();
+	});
+
+	void *mem = ::operator new(sizeof(Block)+trcount*sizeof(Transform)+count*sizeof(std::uint32_t)+textsz);
+	Block *b = new(mem) Block{{1},count,trcount};
+	Transform *trwr = b->transforms();
+	walkTransforms([&](const Transform &t){*trwr++ = t;});
+	char *wr = b->text();
+	std::size_t end = 0;
+	std::uint32_t idx = 0;
+	walkLevels([&](std::string_view txt){
+		//the rendering should be same as in the first pass, but never write out of the block
+		std::size_t len = std::min(txt.size(), textsz - end);
+		std::memcpy(wr+end, txt.data(), len);
+		end += len;
+		b->ends()[idx++] = static_cast<std::uint32_t>(end);
+	});
+	tmp.clear();
+	ContextSnapshot out;
+	out.blk = b;
+	return out;
+}
+
+inline ContextSnapshot captureContext() {
+	return ContextSnapshot::capture();
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+///Wraps an awaiter, detaches the scope while the coroutine is suspended
+/**
+ * Coroutine can be resumed on different thread. The scope is detached from the thread
+ * before the coroutine is suspended and it is attached to the thread which resumed the coroutine.
+ * Contexts created inside of the coroutine after the scope move together with the scope
+ *
+ * @code
+ * ContextSnapshot::Scope scope(snap);
+ * co_await bindContext(scope, socket.async_read());
+ * @endcode
+ */
+template<typename Awaiter>
+class ContextAwaiter {
+public:
+	ContextAwaiter(ContextSnapshot::Scope &scope, Awaiter &&awt)
+		:scope(scope),awt(std::forward<Awaiter>(awt)) {}
+
+	bool await_ready() {return awt.await_ready();}
+	template<typename Promise>
+	auto await_suspend(std::coroutine_handle<Promise> h) {
+		scope.suspend();
+		suspended = true;
+		return awt.await_suspend(h);
+	}
+	decltype(auto) await_resume() {
+		if (suspended) scope.resume();
+		return awt.await_resume();
+	}
+
+protected:
+	ContextSnapshot::Scope &scope;
+	Awaiter awt;
+	bool suspended = false;
+};
+
+template<typename Awaiter>
+ContextAwaiter<Awaiter> bindContext(ContextSnapshot::Scope &scope, Awaiter &&awt) {
+	return ContextAwaiter<Awaiter>(scope, std::forward<Awaiter>(awt));
+}
+
+#endif
+
+}
+
+
+
+#endif /* LOG4HPP_CONTEXT_SNAPSHOT_H_ */
@@ -0,0 +1,109 @@
+/*
+ * crash_handler.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_CRASH_HANDLER_H_
+#define LOG4HPP_CRASH_HANDLER_H_
+
+#include <atomic>
+#include <csignal>
+#include <initializer_list>
+#include <memory>
+#include <signal.h>
+
+#include "backend.h"
+#include "context.h"
+
+namespace log4hpp {
+
+///Writes buffered log data when the process crashes
+/**
+ * Crash handler is opt-in. Once installed, fatal signals are caught, the backend writes content
+ * of the flight recorder, buffered data of the appender, the message which was being logged by
+ * the crashing thread (using only async-signal-safe functions) and a final line "*** fatal signal N ***".
+ * Then the previous handler is restored and the signal is raised again, so the process is terminated
+ * as usual (core dump is created, etc).
+ *
+ * To handle stack overflow, the thread needs alternate signal stack (sigaltstack), the handler
+ * is installed with SA_ONSTACK
+ */
+class CrashHandler {
+public:
+
+	///Install crash handler for given backend
+	/**
+	 * @param backend backend which receives the crash dump. The backend is held until uninstall()
+	 * @param signals list of signals
+	 */
+	static void install(std::shared_ptr<IBackend> backend,
+			std::initializer_list<int> signals = {SIGSEGV, SIGABRT, SIGBUS, SIGILL, SIGFPE});
+
+	///Install crash handler for currently installed backend
+	static void install(std::initializer_list<int> signals = {SIGSEGV, SIGABRT, SIGBUS, SIGILL, SIGFPE}) {
+		install(std::atomic_load(&GlobalContext::current().backend), signals);
+	}
+
+	///Uninstall crash handler, restores previous handlers
+	static void uninstall();
+
+protected:
+
+	struct State {
+		std::atomic<IBackend *> target = {nullptr};
+		std::shared_ptr<IBackend> keep;
+		struct sigaction prev[NSIG];
+		bool installed[NSIG] = {};
+	};
+
+	static State &state() {
+		static State st;
+		return st;
+	}
+
+	static void handler(int sig, siginfo_t *, void *);
+};
+
+inline void CrashHandler::install(std::shared_ptr<IBackend> backend, std::initializer_list<int> signals) {
+	State &st = state();
+	st.keep = backend;
+	st.target.store(backend.get(), std::memory_order_release);
+	for (int sig: signals) {
+		if (sig <= 0 || sig >= NSIG || st.installed[sig]) continue;
+		struct sigaction sa = {};
+		sa.sa_sigaction = &handler;
+		sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+		sigemptyset(&sa.sa_mask);
+		if (sigaction(sig, &sa, &st.prev[sig]) == 0) st.installed[sig] = true;
+	}
+}
+
+inline void CrashHandler::uninstall() {
+	State &st = state();
+	for (int sig = 1; sig < NSIG; sig++) {
+		if (st.installed[sig]) {
+			sigaction(sig, &st.prev[sig], nullptr);
+			st.installed[sig] = false;
+		}
+	}
+	st.target.store(nullptr, std::memory_order_release);
+	st.keep.reset();
+}
+
+inline void CrashHandler::handler(int sig, siginfo_t *, void *) {
+	State &st = state();
+	//only the first crashing thread writes the dump
+	IBackend *bk = st.target.exchange(nullptr, std::memory_order_acq_rel);
+	if (bk) bk->crash_dump(sig);
+	sigaction(sig, &st.prev[sig], nullptr);
+	raise(sig);
+}
+
+
+}
+
+
+
+#endif /* LOG4HPP_CRASH_HANDLER_H_ */
@@ -0,0 +1,39 @@
+/*
+ * file_index.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_FILE_INDEX_H_
+#define LOG4HPP_FILE_INDEX_H_
+
+#include <cstdint>
+
+namespace log4hpp {
+
+///Sparse time index of a log file (sidecar file `<file>.idx`)
+/**
+ * The index file starts by the magic (8 bytes), then entries follow. Entries are
+ * written in native byte order. Each entry points to the beginning of a line, entries are
+ * ordered by the offset, time is increasing (except small differences between threads)
+ */
+struct FileIndex {
+	static constexpr char magic[8] = {'L','4','H','I','D','X','1','\n'};
+
+	struct Entry {
+		///time of the line in nanoseconds since epoch
+		std::int64_t time;
+		///number of the message ({N}), zero if the format doesn't contain it
+		std::uint64_t seq;
+		///offset of the line in the log file
+		std::uint64_t offset;
+	};
+
+	///suffix of the index file
+	static constexpr const char *suffix = ".idx";
+};
+
+}
+
+#endif /* LOG4HPP_FILE_INDEX_H_ */
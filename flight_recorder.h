@@ -0,0 +1,161 @@
+/*
+ * flight_recorder.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_FLIGHT_RECORDER_H_
+#define LOG4HPP_FLIGHT_RECORDER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+
+#include "level.h"
+#include "timestamp.h"
+
+namespace log4hpp {
+
+///In-memory ring of recent messages
+/**
+ * The ring consists of fixed count of fixed size slots. Each slot keeps the text of the message,
+ * its level, thread and time, the line is rendered when the ring is dumped. Writing a message is
+ * one atomic increment and memcpy into the slot, messages longer than the slot are truncated. The
+ * oldest messages are overwritten when the ring is full.
+ *
+ * Every slot is protected by a sequence number, so the reader can detect slots which are being
+ * written or which were overwritten during reading. Reading doesn't allocate and doesn't
+ * lock, so it can be called from a signal handler.
+ */
+class FlightRecorder {
+public:
+
+	///Recorded message
+	struct Entry {
+		std::string_view message;
+		Level::Type level;
+		ThreadId threadId;
+		///time captured at the call site
+		Timestamp::Tick time;
+	};
+
+	///Construct the recorder
+	/**
+	 * @param slots count of slots (count of messages kept)
+	 * @param slotSize maximum size of a message
+	 */
+	FlightRecorder(std::size_t slots = 4096, std::size_t slotSize = 256);
+
+	FlightRecorder(const FlightRecorder &) = delete;
+	FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+	///Record the message
+	void record(Level::Type level, ThreadId threadId, Timestamp::Tick time, const std::string_view &message);
+
+	///Reads and consumes recorded messages
+	/**
+	 * @param fn function called for every message (const Entry &) in order of recording, (oldest first)
+	 * @return count of messages. If there is other dump in progress, function returns 0 immediately
+	 *
+	 * @note function is async-signal-safe as long as the callback is async-signal-safe
+	 */
+	template<typename Fn>
+	std::size_t dump(Fn &&fn);
+
+	///Count of slots
+	std::size_t capacity() const {return slots;}
+
+protected:
+
+	struct SlotHdr {
+		std::atomic<std::uint64_t> seq;
+		std::uint32_t size;
+		Level::Type level;
+		ThreadId threadId;
+		Timestamp::Tick time;
+	};
+
+	std::size_t slots;
+	std::size_t slotSize;
+	std::size_t stride;
+	std::unique_ptr<char[]> mem;
+	std::atomic<std::uint64_t> writePos = {0};
+	std::atomic<std::uint64_t> readPos = {0};
+	std::atomic_flag dumping = ATOMIC_FLAG_INIT;
+
+	SlotHdr *slot(std::size_t idx) {
+		return reinterpret_cast<SlotHdr *>(mem.get()+idx*stride);
+	}
+	char *slotData(SlotHdr *s) {
+		return reinterpret_cast<char *>(s+1);
+	}
+
+};
+
+inline FlightRecorder::FlightRecorder(std::size_t slots, std::size_t slotSize)
+	:slots(slots?slots:1)
+	,slotSize(slotSize)
+	,stride((sizeof(SlotHdr)+slotSize+alignof(SlotHdr)-1) & ~(alignof(SlotHdr)-1))
+	,mem(new char[(this->slots+1)*stride])	//the last slot is used for reading
+{
+	for (std::size_t i = 0; i <= this->slots; i++) {
+		SlotHdr *s = new(slot(i)) SlotHdr;
+		s->seq.store(0, std::memory_order_relaxed);
+		s->size = 0;
+		s->level = Level::nolevel;
+		s->threadId = 0;
+		s->time = 0;
+	}
+}
+
+inline void FlightRecorder::record(Level::Type level, ThreadId threadId, Timestamp::Tick time, const std::string_view &message) {
+	std::uint64_t idx = writePos.fetch_add(1, std::memory_order_relaxed);
+	SlotHdr *s = slot(idx % slots);
+	s->seq.store(2*idx+1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	std::size_t sz = std::min(message.size(), slotSize);
+	std::memcpy(slotData(s), message.data(), sz);
+	s->size = static_cast<std::uint32_t>(sz);
+	s->level = level;
+	s->threadId = threadId;
+	s->time = time;
+	s->seq.store(2*idx+2, std::memory_order_release);
+}
+
+template<typename Fn>
+inline std::size_t FlightRecorder::dump(Fn &&fn) {
+	if (dumping.test_and_set(std::memory_order_acquire)) return 0;
+	std::uint64_t end = writePos.load(std::memory_order_acquire);
+	std::uint64_t beg = readPos.load(std::memory_order_relaxed);
+	if (end - beg > slots) beg = end - slots;
+	SlotHdr *tmp = slot(slots);
+	std::size_t cnt = 0;
+	for (std::uint64_t idx = beg; idx < end; idx++) {
+		SlotHdr *s = slot(idx % slots);
+		std::uint64_t seq = s->seq.load(std::memory_order_acquire);
+		if (seq != 2*idx+2) continue;	//still writting or overwritten
+		std::uint32_t sz = s->size;
+		Entry e{std::string_view(), s->level, s->threadId, s->time};
+		std::memcpy(slotData(tmp), slotData(s), std::min<std::size_t>(sz, slotSize));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (s->seq.load(std::memory_order_relaxed) != seq) continue;
+		e.message = std::string_view(slotData(tmp), std::min<std::size_t>(sz, slotSize));
+		fn(e);
+		++cnt;
+	}
+	readPos.store(end, std::memory_order_relaxed);
+	dumping.clear(std::memory_order_release);
+	return cnt;
+}
+
+
+}
+
+
+
+#endif /* LOG4HPP_FLIGHT_RECORDER_H_ */
@@ -8,6 +8,23 @@
 #ifndef LOG4HPP_FORMAT_H_
 #define LOG4HPP_FORMAT_H_
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "hex_encoder.h"
 
 /**
  *
@@ -23,8 +40,247 @@
 
 namespace log4hpp {
 
-template<typename T> class Stringify;
+template<typename T, typename = void> class Stringify;
+
+namespace _details {
+
+	///Returns true, if the output doesn't accept more characters (LimitedOut)
+	template<typename Out>
+	auto isExhausted(const Out &out, int) -> decltype(out.exhausted()) {
+		return out.exhausted();
+	}
+	template<typename Out>
+	constexpr bool isExhausted(const Out &, long) {
+		return false;
+	}
+
+	///Reports characters, which were not written because the output is exhausted
+	template<typename Out>
+	auto skipOut(Out &out, std::size_t n, int) -> decltype(out.skip(n)) {
+		return out.skip(n);
+	}
+	template<typename Out>
+	void skipOut(Out &, std::size_t, long) {}
+
+	///Writes block of characters at once, if the output supports it
+	template<typename Out>
+	auto writeBlock(Out &out, const char *data, std::size_t sz, int) -> decltype(out.append(data, sz)) {
+		return out.append(data, sz);
+	}
+	template<typename Out>
+	void writeBlock(Out &out, const char *data, std::size_t sz, long) {
+		for (std::size_t i = 0; i < sz; i++) out(data[i]);
+	}
+
+	///Writes text which is not part of the content (LimitedOut doesn't count it to the total)
+	template<typename Out>
+	auto writeMark(Out &out, const char *data, std::size_t sz, int) -> decltype(out.mark(data, sz)) {
+		return out.mark(data, sz);
+	}
+	template<typename Out>
+	void writeMark(Out &out, const char *data, std::size_t sz, long) {
+		writeBlock(out, data, sz, 0);
+	}
+
+	///Writes truncation mark with the original size
+	template<typename Out>
+	void writeTruncated(Out &out, std::size_t size) {
+		constexpr std::string_view prefix("...[truncated: ");
+		constexpr std::string_view suffix(" bytes]");
+		char buff[prefix.size()+24+suffix.size()];
+		char num[24];
+		int n = 0;
+		do {num[n++] = '0' + size % 10; size /= 10;} while (size);
+		std::size_t p = prefix.copy(buff, prefix.size());
+		while (n) buff[p++] = num[--n];
+		p += suffix.copy(buff+p, suffix.size());
+		writeMark(out, buff, p, 0);
+	}
+
+	///Writes bytes as hex digits
+	template<typename Out>
+	void writeHex(const std::string_view &data, Out &out) {
+		constexpr std::size_t chunk = 512;
+		char buff[chunk*2];
+		for (std::size_t i = 0; i < data.size(); i += chunk) {
+			if (isExhausted(out, 0)) {
+				skipOut(out, (data.size() - i)*2, 0);
+				return;
+			}
+			std::size_t n = std::min(chunk, data.size() - i);
+			HexEncoder::encode(reinterpret_cast<const unsigned char *>(data.data()+i), n, buff);
+			writeBlock(out, buff, n*2, 0);
+		}
+	}
 
+	template<int digits>
+	char *writeDumpOffset(std::size_t ofs, char *wr) {
+		for (int d = digits-1; d >= 0; d--) *wr++ = "0123456789abcdef"[(ofs >> (d*4)) & 0xF];
+		return wr;
+	}
+
+	///Writes bytes in the layout of `hexdump -C` (each row starts by a new line)
+	/**
+	 * @code
+	 * 00000000  48 65 6c 6c 6f 20 77 6f  72 6c 64 0a 00 01 02 03  |Hello world.....|
+	 * @endcode
+	 */
+	template<typename Out>
+	void writeHexDump(const std::string_view &data, Out &out) {
+		constexpr std::size_t rowBytes = 16;
+		constexpr std::size_t rows = 32;
+		//new line + offset (up to 16 digits) + 2 spaces + row
+		char buff[rows*(1+16+2+HexEncoder::dumpRowSize)];
+		const unsigned char *src = reinterpret_cast<const unsigned char *>(data.data());
+		std::size_t sz = data.size();
+		std::size_t ofs = 0;
+		while (ofs < sz) {
+			if (isExhausted(out, 0)) {
+				std::size_t rest = (sz - ofs + rowBytes - 1)/rowBytes;
+				skipOut(out, rest * (1+8+2+HexEncoder::dumpRowSize), 0);
+				return;
+			}
+			char *wr = buff;
+			for (std::size_t r = 0; r < rows && ofs < sz; r++, ofs += rowBytes) {
+				*wr++ = '\n';
+				if (ofs > 0xFFFFFFFFU) wr = writeDumpOffset<16>(ofs, wr);
+				else wr = writeDumpOffset<8>(ofs, wr);
+				*wr++ = ' ';
+				*wr++ = ' ';
+				wr += HexEncoder::dumpRow(src+ofs, std::min(rowBytes, sz - ofs), wr);
+			}
+			writeBlock(out, buff, wr - buff, 0);
+		}
+	}
+
+}
+
+///Output which stops writing after given count of bytes
+/**
+ * Stringify functions stop early, when the output is exhausted. They can report count of
+ * the skipped characters, so the total size is known. The total is the size of the content
+ * without any limit, truncation marks written by mark() are not part of it.
+ */
+template<typename Out>
+class LimitedOut {
+public:
+	LimitedOut(Out &out, std::size_t limit):out(out),limit(limit) {}
+
+	void operator()(char c) {
+		++offered;
+		if (count < limit) {
+			out(c);
+			++count;
+		} else {
+			cut = true;
+		}
+	}
+	void push_back(char c) {operator()(c);}
+	void append(const std::string_view &txt) {append(txt.data(), txt.size());}
+	void append(const char *data, std::size_t sz) {
+		offered += sz;
+		write(data, sz);
+	}
+	///Writes text which is not part of the content (truncation mark), it is not counted to the total
+	void mark(const char *data, std::size_t sz) {write(data, sz);}
+	///Counts characters, which were not written
+	void skip(std::size_t n) {
+		offered += n;
+		if (n) cut = true;
+	}
+	///Returns true, if the limit was reached
+	bool exhausted() const {return count >= limit || _details::isExhausted(out, 0);}
+	///Returns true, if some characters were not written
+	bool truncated() const {return cut;}
+	///Returns count of written bytes
+	std::size_t size() const {return count;}
+	///Returns size of the content including the bytes which were not written
+	std::size_t total() const {return offered;}
+
+	///Creates output for a part of the text (an argument) with own limit
+	/** The part writes directly to the underlying output, use merge() to count it */
+	LimitedOut part(std::size_t partLimit) {
+		return LimitedOut(out, std::min(partLimit, count < limit?limit - count:0));
+	}
+	///Counts characters written by the part
+	/**
+	 * The whole size of the part is added to the total. The output is truncated, only when
+	 * the part was cut by the remaining space (not by its own limit)
+	 */
+	void merge(const LimitedOut &p, std::size_t partLimit) {
+		count += p.count;
+		offered += p.offered;
+		if (p.cut && p.limit < partLimit) cut = true;
+	}
+
+protected:
+	Out &out;
+	std::size_t limit;
+	std::size_t count = 0;
+	std::size_t offered = 0;
+	bool cut = false;
+
+	void write(const char *data, std::size_t sz) {
+		std::size_t n = count < limit?std::min(sz, limit - count):0;
+		_details::writeBlock(out, data, n, 0);
+		count += n;
+		if (n < sz) cut = true;
+	}
+};
+
+namespace _details {
+
+	template<typename Out> struct IsLimitedOut: std::false_type {};
+	template<typename Out> struct IsLimitedOut<LimitedOut<Out> >: std::true_type {};
+
+}
+
+
+namespace _details {
+
+	template<typename T, typename Out>
+	auto stringifyValue(const T &val, const std::string_view &fmt, Out &out) -> decltype(std::declval<Stringify<decltype(std::declval<T>()())> >()(std::declval<T>()(), fmt, out)) {
+		Stringify<decltype(val())> s;
+		s(val(), fmt, out);
+	}
+	template<typename T, typename Out>
+	auto stringifyValue(const T &val, const std::string_view &fmt, Out &out) -> decltype(std::declval<Stringify<T> >()(std::declval<T>(), fmt, out)) {
+		Stringify<T> s;
+		s(val, fmt, out);
+	}
+
+	///Type-erased argument (compiled mode)
+	/**
+	 * Holds pointer to the value and the function which formats it to LimitedOut<Out>. The parser of
+	 * the format string is then instantiated only once for all types of arguments.
+	 */
+	template<typename Out>
+	class FormatArg {
+	public:
+		FormatArg() = default;
+		template<typename T>
+		FormatArg(const T &val):ptr(&val),fn(&format<T>) {}
+
+		void operator()(const std::string_view &fmt, LimitedOut<Out> &out) const {fn(ptr, fmt, out);}
+
+	protected:
+		const void *ptr = nullptr;
+		void (*fn)(const void *, const std::string_view &, LimitedOut<Out> &) = nullptr;
+
+		template<typename T>
+		static void format(const void *ptr, const std::string_view &fmt, LimitedOut<Out> &out) {
+			stringifyValue(*static_cast<const T *>(ptr), fmt, out);
+		}
+	};
+
+	///List of type-erased arguments
+	template<typename Out>
+	struct ArgList {
+		const FormatArg<Out> *args;
+		std::size_t count;
+	};
+
+}
 
 template<typename Out, typename MapType>
 class FormatT {
@@ -37,21 +293,52 @@ public:
 	template<typename ... Args>
 	void operator()(const std::string_view &format, const Args & ... args);
 
+	///Sets maximum size of each argument in bytes
+	/** Longer arguments are truncated and marked with the original size */
+	void setArgumentLimit(std::size_t limit) {argLimit = limit;}
+
 
 protected:
 	MapType map;
 	Out out;
+	std::size_t argLimit = static_cast<std::size_t>(-1);
 
 
 	template<typename T>
 	auto formatItem(const std::string_view &format_spec, const T &val) -> decltype(std::declval<Stringify<decltype(std::declval<T>()())> >()(std::declval<T>()(), std::declval<std::string_view>(), std::declval<OutRef &>())){
-		Stringify<decltype(std::declval<T>()())> s;
-		s(val(),format_spec, out);
+		writeItem<decltype(std::declval<T>()())>(val(), format_spec);
 	}
 	template<typename T>
 	auto formatItem(const std::string_view &format_spec, const T &val) -> decltype(std::declval<Stringify<T> >()(std::declval<T>(), std::declval<std::string_view>(), std::declval<OutRef &>())){
+		writeItem<T>(val, format_spec);
+	}
+
+	template<typename T, typename V>
+	void writeItem(const V &val, const std::string_view &format_spec) {
 		Stringify<T> s;
-		s(val,format_spec, out);
+		if (argLimit == static_cast<std::size_t>(-1)) {
+			s(val,format_spec, out);
+		} else {
+			writeLimited([&](auto &lout){s(val, format_spec, lout);});
+		}
+	}
+
+	///Writes an argument with the argument limit
+	/** When the output is LimitedOut, the argument is written as its part, so the total size of the
+	 * message is the same for header-only and compiled mode */
+	template<typename Fn>
+	void writeLimited(Fn &&fn) {
+		using O = std::remove_reference_t<Out>;
+		if constexpr(_details::IsLimitedOut<O>::value) {
+			auto part = out.part(argLimit);
+			fn(part);
+			out.merge(part, argLimit);
+			if (part.truncated()) _details::writeTruncated(out, part.total());
+		} else {
+			LimitedOut<O> lout(out, argLimit);
+			fn(lout);
+			if (lout.truncated()) _details::writeTruncated(out, lout.total());
+		}
 	}
 
 	template<typename T, typename ... Args>
@@ -67,6 +354,28 @@ protected:
 		out.append("{?}");
 	};
 
+	template<typename X>
+	void formatNth(const std::string_view &format_spec, unsigned int nth, const _details::ArgList<X> &args) {
+		if (nth == 0 || nth > args.count) out.append("{?}");
+		else formatArg(format_spec, args.args[nth-1]);
+	}
+
+	template<typename X>
+	void formatNext(const std::string_view &fmt_spec, const std::string_view &format, const _details::ArgList<X> &args) {
+		if (args.count == 0) return formatNext(fmt_spec, format);
+		formatArg(fmt_spec, args.args[0]);
+		operator()(format, _details::ArgList<X>{args.args+1, args.count-1});
+	}
+
+	template<typename X>
+	void formatArg(const std::string_view &format_spec, const _details::FormatArg<X> &arg) {
+		if (argLimit == static_cast<std::size_t>(-1)) {
+			arg(format_spec, out);
+		} else {
+			writeLimited([&](auto &part){arg(format_spec, part);});
+		}
+	}
+
 	template<typename T, typename ... Args>
 	void formatNext(const std::string_view &fmt_spec, const std::string_view &format, const T &val, const Args & ... args) {
 		formatItem(fmt_spec, val);
@@ -277,6 +586,7 @@ public:
 		bool align_right = false;
 		bool utf8 = false;
 		bool bin = false;
+		bool hexdump = false;
 
 		for(char c: fmt) {
 			switch (c) {
@@ -292,6 +602,7 @@ public:
 			case '9': space = space * 10 + (c - '0');
 			case 'r': dots = false;utf8=false;escape=false;bin=false;break;
 			case 'b': bin = true;break;
+			case 'h': hexdump = true;break;
 			case 'q': quotes = true; qchar='"';break;
 			case 'a': quotes = true; qchar='\'';break;
 			case 'd': dbl = true;break;
@@ -304,18 +615,42 @@ public:
 			}
 		}
 
-		auto process = [&](const std::string_view &str, auto &&out) {
+		if (hexdump) {
+			_details::writeHexDump(val, out);
+			return;
+		}
+		if (bin) {
+			std::size_t cnt = val.size()*2 + (quotes?2:0);
+			std::size_t pad = static_cast<std::size_t>(space) > cnt?space - cnt:0;
+			if (align_right) for (std::size_t i = 0; i < pad; i++) out(' ');
+			if (quotes) out(qchar);
+			_details::writeHex(val, out);
+			if (quotes) out(qchar);
+			if (!align_right) for (std::size_t i = 0; i < pad; i++) out(' ');
+			return;
+		}
+
+		auto &sink = out;
+		int width = 0;
+		//when the output is exhausted, the rest is skipped and reported by its size in the source
+		//(escaped text would be longer). The counting pass measures the width for the padding,
+		//it stops at the padding width and it doesn't report skipped characters
+		auto process = [&](auto &&out, bool counting) {
 			using OutRef = std::remove_reference_t<decltype(out)>;
 			if (quotes) {
 				out(qchar);
 			}
 			int utfn = 0;
 			unsigned int uchr = 0;
-			for (char c: val) {
-				if (bin) {
-					StringifyUnsigned::writeNumber(static_cast<unsigned char>(c), 2, 16, std::forward<OutRef>(out));
-					continue;
+			for (std::size_t i = 0, cnt = val.size(); i < cnt; i++) {
+				if (counting) {
+					if (width >= space) break;
+				} else if (_details::isExhausted(sink, 0)) {
+					//stop early, when the output is limited
+					_details::skipOut(sink, cnt - i, 0);
+					break;
 				}
+				char c = val[i];
 				if (escape) {
 					switch (c) {
 					case '\f': out('\\');out('f');continue;
@@ -393,15 +728,14 @@ public:
 		int bspace = 0;
 		int aspace = 0;
 		if (space) {
-			int cnt = 0;
-			process(val, [&](char){++cnt;});
-			if (cnt < space) {
-				if (align_right) bspace = space - cnt;
-				else aspace = space - cnt;
+			process([&](char){++width;}, true);
+			if (width < space) {
+				if (align_right) bspace = space - width;
+				else aspace = space - width;
 			}
 		}
 		for (int i =  0; i <bspace; i++) out(' ');
-		process(val,[&](char c){out(c);});
+		process([&](char c){out(c);}, false);
 		for (int i =  0; i <aspace; i++) out(' ');
 	}
 };
@@ -426,7 +760,7 @@ public:
 };
 
 template<> class Stringify<bool> {public: template<typename Out> void operator()(bool val, const std::string_view &fmt, Out &out) {
-	for (char c: val?"true":"false") out(c);
+	for (char c: std::string_view(val?"true":"false")) out(c);
 }
 };
 
@@ -451,6 +785,7 @@ template<> class Stringify<signed long long>: public StringifySigned {};
 template<> class Stringify<std::string>: public StringifyString {};
 template<> class Stringify<std::string_view>: public StringifyString {};
 template<> class Stringify<const char *>: public StringifyString {};
+template<> class Stringify<char *>: public StringifyString {};
 template<int n> class Stringify<const char [n]>: public StringifyString {};
 template<int n> class Stringify<char [n]>: public StringifyString {};
 template<> class Stringify<float>: public StringifyReal {};
@@ -473,6 +808,282 @@ public: template<typename Out> void operator()(const DirectString &val, const st
 }
 };
 
+namespace _details {
+
+	template<typename T, typename = void>
+	struct IsRange: std::false_type {};
+	template<typename T>
+	struct IsRange<T, std::void_t<decltype(std::begin(std::declval<const T &>())),
+							decltype(std::end(std::declval<const T &>()))> >
+		: std::bool_constant<!std::is_convertible_v<const T &, std::string_view> > {};
+
+	template<typename T, typename = void>
+	struct IsMap: std::false_type {};
+	template<typename T>
+	struct IsMap<T, std::void_t<typename T::key_type, typename T::mapped_type> >: std::true_type {};
+
+	template<typename T>
+	auto rangeSize(const T &val, int) -> decltype(static_cast<std::size_t>(std::size(val))) {
+		return static_cast<std::size_t>(std::size(val));
+	}
+	template<typename T>
+	std::size_t rangeSize(const T &, long) {
+		return static_cast<std::size_t>(-1);
+	}
+
+	template<typename T, typename Out>
+	void stringifyItem(const T &val, const std::string_view &fmt, Out &out) {
+		Stringify<std::remove_cv_t<T> > s;
+		s(val, fmt, out);
+	}
+
+	template<typename Out>
+	void writeText(const std::string_view &txt, Out &out) {
+		for (char c: txt) out(c);
+	}
+
+	inline const char *strerrorResult(int, const char *buff) {return buff;}
+	inline const char *strerrorResult(const char *res, const char *) {return res;}
+
+}
+
+///Ranges and containers
+/**
+ * Format: [items][.bytes][:elemspec]
+ *
+ * - items - maximum count of rendered items (default 64)
+ * - bytes - maximum size of rendered items in bytes, separators are not counted (default 1024)
+ * - elemspec - format of each item
+ *
+ * Output: [1, 2, 3, ...(+N)], maps are rendered as {key: value, ...}
+ */
+template<typename T>
+class Stringify<T, std::enable_if_t<_details::IsRange<T>::value> > {
+public:
+	template<typename Out>
+	void operator()(const T &val, const std::string_view &fmt, Out &out) {
+		std::size_t items = 64;
+		std::size_t bytes = 1024;
+		std::string_view elemfmt;
+		auto sep = fmt.find(':');
+		if (sep != fmt.npos) elemfmt = fmt.substr(sep+1);
+		auto limits = fmt.substr(0, sep);
+		auto dot = limits.find('.');
+		if (dot != 0) items = parse(limits.substr(0, dot), items);
+		if (dot != limits.npos) bytes = parse(limits.substr(dot+1), bytes);
+		constexpr bool isMap = _details::IsMap<T>::value;
+		out(isMap?'{':'[');
+		LimitedOut<Out> lout(out, bytes);
+		std::size_t n = 0;
+		auto iter = std::begin(val);
+		auto end = std::end(val);
+		for (; iter != end && n < items && !lout.exhausted(); ++iter, ++n) {
+			//separators are not counted to the limit
+			if (n) {out(',');out(' ');}
+			if constexpr(isMap) {
+				_details::stringifyItem(iter->first, std::string_view(), lout);
+				lout(':');lout(' ');
+				_details::stringifyItem(iter->second, elemfmt, lout);
+			} else {
+				_details::stringifyItem(*iter, elemfmt, lout);
+			}
+		}
+		if (iter != end || lout.exhausted()) {
+			_details::writeText(n?", ...":"...", out);
+			std::size_t sz = _details::rangeSize(val, 0);
+			if (sz != static_cast<std::size_t>(-1) && sz > n) {
+				_details::writeText("(+", out);
+				StringifyUnsigned::writeNumber(sz - n, 1, 10, out);
+				out(')');
+			}
+		}
+		out(isMap?'}':']');
+	}
+protected:
+	static std::size_t parse(const std::string_view &txt, std::size_t def) {
+		if (txt.empty()) return def;
+		std::size_t r = 0;
+		for (char c: txt) if (isdigit(c)) r = r * 10 + (c - '0');
+		return r;
+	}
+};
+
+///std::optional, empty optional is rendered as "none"
+template<typename T>
+class Stringify<std::optional<T> > {
+public:
+	template<typename Out>
+	void operator()(const std::optional<T> &val, const std::string_view &fmt, Out &out) {
+		if (val.has_value()) _details::stringifyItem(*val, fmt, out);
+		else _details::writeText("none", out);
+	}
+};
+
+///std::pair rendered as (first, second), the format is used for both items
+template<typename A, typename B>
+class Stringify<std::pair<A, B> > {
+public:
+	template<typename Out>
+	void operator()(const std::pair<A, B> &val, const std::string_view &fmt, Out &out) {
+		out('(');
+		_details::stringifyItem(val.first, fmt, out);
+		out(',');out(' ');
+		_details::stringifyItem(val.second, fmt, out);
+		out(')');
+	}
+};
+
+///std::tuple rendered as (a, b, c), the format is used for all items
+template<typename ... Args>
+class Stringify<std::tuple<Args...> > {
+public:
+	template<typename Out>
+	void operator()(const std::tuple<Args...> &val, const std::string_view &fmt, Out &out) {
+		out('(');
+		std::apply([&](const auto & ... items) {
+			bool first = true;
+			auto item = [&](const auto &v) {
+				if (!first) {out(',');out(' ');}
+				first = false;
+				_details::stringifyItem(v, fmt, out);
+			};
+			(item(items),...);
+		}, val);
+		out(')');
+	}
+};
+
+///std::chrono::duration
+/**
+ * Without format the count is rendered with the unit (150ms). Format can contain
+ * a unit (ns, us, ms, s, min, h), then the duration is converted (0.15s)
+ */
+template<typename Rep, typename Period>
+class Stringify<std::chrono::duration<Rep, Period> > {
+public:
+	template<typename Out>
+	void operator()(const std::chrono::duration<Rep, Period> &val, const std::string_view &fmt, Out &out) {
+		using namespace std::chrono;
+		if (fmt == "ns") return convert<std::nano>(val, fmt, out);
+		if (fmt == "us") return convert<std::micro>(val, fmt, out);
+		if (fmt == "ms") return convert<std::milli>(val, fmt, out);
+		if (fmt == "s") return convert<std::ratio<1> >(val, fmt, out);
+		if (fmt == "min") return convert<std::ratio<60> >(val, fmt, out);
+		if (fmt == "h") return convert<std::ratio<3600> >(val, fmt, out);
+		_details::stringifyItem(val.count(), std::string_view(), out);
+		if constexpr(std::is_same_v<Period, std::nano>) _details::writeText("ns", out);
+		else if constexpr(std::is_same_v<Period, std::micro>) _details::writeText("us", out);
+		else if constexpr(std::is_same_v<Period, std::milli>) _details::writeText("ms", out);
+		else if constexpr(std::is_same_v<Period, std::ratio<1> >) _details::writeText("s", out);
+		else if constexpr(std::is_same_v<Period, std::ratio<60> >) _details::writeText("min", out);
+		else if constexpr(std::is_same_v<Period, std::ratio<3600> >) _details::writeText("h", out);
+		else {
+			_details::writeText("*(", out);
+			StringifySigned()(static_cast<long long>(Period::num), std::string_view(), out);
+			out('/');
+			StringifySigned()(static_cast<long long>(Period::den), std::string_view(), out);
+			_details::writeText(")s", out);
+		}
+	}
+protected:
+	template<typename P, typename Out>
+	static void convert(const std::chrono::duration<Rep, Period> &val, const std::string_view &unit, Out &out) {
+		StringifyReal()(std::chrono::duration<double, P>(val).count(), std::string_view(), out);
+		_details::writeText(unit, out);
+	}
+};
+
+///std::chrono::time_point
+/**
+ * Time point of the system clock is rendered in UTC as 2026-10-19T10:00:00.123Z, the format
+ * can contain strftime() format (UTC). Time points of other clocks are rendered as duration
+ * since the epoch of the clock
+ */
+template<typename Clock, typename Dur>
+class Stringify<std::chrono::time_point<Clock, Dur> > {
+public:
+	template<typename Out>
+	void operator()(const std::chrono::time_point<Clock, Dur> &val, const std::string_view &fmt, Out &out) {
+		if constexpr(std::is_same_v<Clock, std::chrono::system_clock>) {
+			auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(val.time_since_epoch()).count();
+			long long msr = ms % 1000;
+			if (msr < 0) msr += 1000;
+			std::time_t t = static_cast<std::time_t>((ms - msr) / 1000);
+			struct tm tm;
+			gmtime_r(&t, &tm);
+			char buff[128];
+			std::size_t cnt;
+			if (fmt.empty()) {
+				cnt = std::strftime(buff, sizeof(buff), "%Y-%m-%dT%H:%M:%S", &tm);
+				_details::writeText(std::string_view(buff, cnt), out);
+				out('.');
+				StringifyUnsigned::writeNumber(msr, 3, 10, out);
+				out('Z');
+			} else {
+				char f[64];
+				std::size_t fl = std::min(fmt.size(), sizeof(f)-1);
+				std::memcpy(f, fmt.data(), fl);
+				f[fl] = 0;
+				cnt = std::strftime(buff, sizeof(buff), f, &tm);
+				_details::writeText(std::string_view(buff, cnt), out);
+			}
+		} else {
+			_details::stringifyItem(val.time_since_epoch(), fmt, out);
+		}
+	}
+};
+
+///std::error_code rendered as category:value (message)
+/** Messages of the system and generic category are rendered without allocation */
+template<>
+class Stringify<std::error_code> {
+public:
+	template<typename Out>
+	void operator()(const std::error_code &ec, const std::string_view &, Out &out) {
+		_details::writeText(ec.category().name(), out);
+		out(':');
+		StringifySigned()(ec.value(), std::string_view(), out);
+		if (!ec) return;
+		out(' ');
+		out('(');
+		if (ec.category() == std::system_category() || ec.category() == std::generic_category()) {
+			char buff[256];
+			buff[0] = 0;
+			_details::writeText(_details::strerrorResult(strerror_r(ec.value(), buff, sizeof(buff)), buff), out);
+		} else {
+			_details::writeText(ec.message(), out);
+		}
+		out(')');
+	}
+};
+
+///Pointers rendered as hexadecimal address (0x7ffc...), null pointer is rendered as "nullptr"
+template<typename T>
+class Stringify<T *> {
+public:
+	template<typename Out>
+	void operator()(T *val, const std::string_view &, Out &out) {
+		if (val == nullptr) {
+			_details::writeText("nullptr", out);
+		} else {
+			out('0');
+			out('x');
+			StringifyUnsigned::writeNumber(reinterpret_cast<std::uintptr_t>(val), 1, 16, [&](char c){
+				out(static_cast<char>(std::tolower(c)));
+			});
+		}
+	}
+};
+
+template<>
+class Stringify<std::nullptr_t> {
+public:
+	template<typename Out>
+	void operator()(std::nullptr_t, const std::string_view &, Out &out) {
+		_details::writeText("nullptr", out);
+	}
+};
+
 
 }
 
@@ -0,0 +1,213 @@
+/*
+ * hex_encoder.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_HEX_ENCODER_H_
+#define LOG4HPP_HEX_ENCODER_H_
+
+#include <cstddef>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(LOG4HPP_NO_SIMD)
+#include <immintrin.h>
+#define LOG4HPP_HAS_SIMD_HEX 1
+#endif
+
+namespace log4hpp {
+
+///Converts binary data to hexadecimal digits
+/**
+ * On x86 the encoder uses AVX2 or SSSE3 (selected at runtime by the CPU), other platforms
+ * use the scalar code. Define LOG4HPP_NO_SIMD to always use the scalar code.
+ */
+class HexEncoder {
+public:
+
+	///Encodes bytes
+	/**
+	 * @param src source bytes
+	 * @param n count of bytes
+	 * @param dst output buffer, must have space for 2*n characters
+	 * @param upper use uppercase letters
+	 */
+	static void encode(const unsigned char *src, std::size_t n, char *dst, bool upper = true) noexcept {
+#ifdef LOG4HPP_HAS_SIMD_HEX
+		static const Impl impl = detect();
+		impl(src, n, dst, digits(upper));
+#else
+		encodeScalar(src, n, dst, digits(upper));
+#endif
+	}
+
+	///Maximum size of the row rendered by dumpRow()
+	static constexpr std::size_t dumpRowSize = 68;
+
+	///Renders row of `hexdump -C` (without the offset)
+	/**
+	 * @param src source bytes
+	 * @param n count of bytes, max 16 (shorter row is padded)
+	 * @param dst output buffer, must have space for dumpRowSize characters
+	 * @return count of written characters
+	 */
+	static std::size_t dumpRow(const unsigned char *src, std::size_t n, char *dst) noexcept {
+#ifdef LOG4HPP_HAS_SIMD_HEX
+		static const bool ssse3 = __builtin_cpu_supports("ssse3");
+		if (n == 16 && ssse3) return dumpRowSSSE3(src, dst);
+#endif
+		return dumpRowScalar(src, n, dst);
+	}
+
+	///Returns name of the used implementation (avx2, ssse3, scalar)
+	static const char *implementation() noexcept {
+#ifdef LOG4HPP_HAS_SIMD_HEX
+		if (__builtin_cpu_supports("avx2")) return "avx2";
+		if (__builtin_cpu_supports("ssse3")) return "ssse3";
+#endif
+		return "scalar";
+	}
+
+protected:
+
+	using Impl = void (*)(const unsigned char *, std::size_t, char *, const char *);
+
+	static const char *digits(bool upper) noexcept {
+		return upper?"0123456789ABCDEF":"0123456789abcdef";
+	}
+
+	static void encodeScalar(const unsigned char *src, std::size_t n, char *dst, const char *dg) noexcept {
+		for (std::size_t i = 0; i < n; i++) {
+			dst[2*i] = dg[src[i] >> 4];
+			dst[2*i+1] = dg[src[i] & 0xF];
+		}
+	}
+
+	///Hex columns: "xx " for each byte, extra space after 8 bytes and before the ascii column
+	static constexpr std::size_t hexColumn(std::size_t i) {return i*3 + (i >= 8);}
+	static constexpr std::size_t hexColumns = 50;
+
+	static std::size_t dumpRowScalar(const unsigned char *src, std::size_t n, char *dst) noexcept {
+		char hex[32];
+		encodeScalar(src, n, hex, digits(false));
+		std::memset(dst, ' ', hexColumns);
+		for (std::size_t i = 0; i < n; i++) {
+			dst[hexColumn(i)] = hex[2*i];
+			dst[hexColumn(i)+1] = hex[2*i+1];
+		}
+		dst += hexColumns;
+		*dst++ = '|';
+		for (std::size_t i = 0; i < n; i++) {
+			dst[i] = src[i] >= 0x20 && src[i] < 0x7F?static_cast<char>(src[i]):'.';
+		}
+		dst[n] = '|';
+		return hexColumns + n + 2;
+	}
+
+#ifdef LOG4HPP_HAS_SIMD_HEX
+
+	///Shuffle masks which place hex digits of the row to the columns (3 x 16 columns)
+	struct RowMasks {
+		///digits of bytes 0-7
+		char lo[3][16];
+		///digits of bytes 8-15
+		char hi[3][16];
+		///spaces between digits
+		char sp[3][16];
+	};
+
+	static constexpr RowMasks makeRowMasks() {
+		RowMasks m = {};
+		for (std::size_t k = 0; k < 3; k++) {
+			for (std::size_t j = 0; j < 16; j++) {
+				m.lo[k][j] = m.hi[k][j] = static_cast<char>(0x80);
+				m.sp[k][j] = ' ';
+			}
+		}
+		for (std::size_t i = 0; i < 16; i++) {
+			for (std::size_t d = 0; d < 2; d++) {
+				std::size_t c = hexColumn(i)+d;
+				m.sp[c/16][c%16] = 0;
+				if (i < 8) m.lo[c/16][c%16] = static_cast<char>(2*i+d);
+				else m.hi[c/16][c%16] = static_cast<char>(2*(i-8)+d);
+			}
+		}
+		return m;
+	}
+
+	__attribute__((target("ssse3")))
+	static std::size_t dumpRowSSSE3(const unsigned char *src, char *dst) noexcept {
+		static constexpr RowMasks m = makeRowMasks();
+		const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits(false)));
+		const __m128i mask = _mm_set1_epi8(0xF);
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+		__m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+		__m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+		__m128i a = _mm_unpacklo_epi8(hi, lo);
+		__m128i b = _mm_unpackhi_epi8(hi, lo);
+		for (int k = 0; k < 3; k++) {
+			__m128i r = _mm_or_si128(
+					_mm_or_si128(_mm_shuffle_epi8(a, _mm_loadu_si128(reinterpret_cast<const __m128i *>(m.lo[k]))),
+								 _mm_shuffle_epi8(b, _mm_loadu_si128(reinterpret_cast<const __m128i *>(m.hi[k])))),
+					_mm_loadu_si128(reinterpret_cast<const __m128i *>(m.sp[k])));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst+16*k), r);
+		}
+		dst[48] = ' ';
+		dst[49] = ' ';
+		dst[50] = '|';
+		//printable characters (signed compare excludes bytes above 127)
+		__m128i pr = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1F)), _mm_cmplt_epi8(v, _mm_set1_epi8(0x7F)));
+		__m128i asc = _mm_or_si128(_mm_and_si128(pr, v), _mm_andnot_si128(pr, _mm_set1_epi8('.')));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst+51), asc);
+		dst[67] = '|';
+		return dumpRowSize;
+	}
+
+	static Impl detect() noexcept {
+		if (__builtin_cpu_supports("avx2")) return encodeAVX2;
+		if (__builtin_cpu_supports("ssse3")) return encodeSSSE3;
+		return encodeScalar;
+	}
+
+	///16 bytes per iteration - nibbles are translated by pshufb, then interleaved
+	__attribute__((target("ssse3")))
+	static void encodeSSSE3(const unsigned char *src, std::size_t n, char *dst, const char *dg) noexcept {
+		const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dg));
+		const __m128i mask = _mm_set1_epi8(0xF);
+		std::size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src+i));
+			__m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+			__m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst+2*i), _mm_unpacklo_epi8(hi, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst+2*i+16), _mm_unpackhi_epi8(hi, lo));
+		}
+		encodeScalar(src+i, n-i, dst+2*i, dg);
+	}
+
+	///32 bytes per iteration, unpack works in lanes, so the lanes are reordered before store
+	__attribute__((target("avx2")))
+	static void encodeAVX2(const unsigned char *src, std::size_t n, char *dst, const char *dg) noexcept {
+		const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(dg)));
+		const __m256i mask = _mm256_set1_epi8(0xF);
+		std::size_t i = 0;
+		for (; i + 32 <= n; i += 32) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src+i));
+			__m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+			__m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+			__m256i a = _mm256_unpacklo_epi8(hi, lo);
+			__m256i b = _mm256_unpackhi_epi8(hi, lo);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst+2*i), _mm256_permute2x128_si256(a, b, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst+2*i+32), _mm256_permute2x128_si256(a, b, 0x31));
+		}
+		encodeSSSE3(src+i, n-i, dst+2*i, dg);
+	}
+
+#endif
+
+};
+
+}
+
+#endif /* LOG4HPP_HEX_ENCODER_H_ */
@@ -30,6 +30,20 @@ namespace Level {
 	constexpr Type debug = 0x7000;
 	///enables all levels
 	constexpr Type max_verbose = 0xFFFF;
+
+#ifndef LOG4HPP_MIN_LEVEL
+#define LOG4HPP_MIN_LEVEL max_verbose
+#endif
+	///most verbose level compiled into the program
+	/**
+	 * Defined by the macro LOG4HPP_MIN_LEVEL (before the first include). Messages with more verbose
+	 * level are removed during compilation. The macro can contain a name of level
+	 * (-DLOG4HPP_MIN_LEVEL=info) or a number (-DLOG4HPP_MIN_LEVEL=0x6000)
+	 */
+	constexpr Type compiled = LOG4HPP_MIN_LEVEL;
+
+	///Returns true, if the level is compiled in
+	constexpr bool isCompiled(Type level) {return level <= compiled;}
 };
 
 using ThreadId = unsigned int;
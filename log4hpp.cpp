@@ -0,0 +1,18 @@
+/*
+ * log4hpp.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Library of the compiled mode (see config.h). Programs which link the library must define
+ * LOG4HPP_COMPILED in all translation units
+ */
+
+#ifndef LOG4HPP_COMPILED
+#define LOG4HPP_COMPILED
+#endif
+#define LOG4HPP_COMPILED_LIBRARY
+
+#include "logger.h"
+#include "unix_file_rotate_appender.h"
+#include "stderr_appender.h"
@@ -11,6 +11,7 @@
 #include <typeinfo>
 #include "format.h"
 #include "backend_impl.h"
+#include "context_snapshot.h"
 
 namespace log {
 
@@ -21,46 +22,67 @@ using namespace log4hpp::Level;
 template<typename ... Args>
 inline void log(log4hpp::Level::Type level, const std::string_view &msg, const Args & ... args) {
 	using namespace log4hpp;
+	if (!Level::isCompiled(level)) return;
 	ThreadContext *current = &ThreadContext::current();
 	if (current->level >= level) {
-		current->buffer.clear();
-		FormatT<Buffer &, NullMap> fmt(current->buffer);
-		fmt(msg, args...);
+		current->time = Timestamp::now();
+		LOG4HPP_ALLOC_SCOPE;
+		formatMessage(*current, msg, args...);
 		current->backend->send(*current, level, current->curCtx, current->buffer);
+		current->trimBuffers();
+	} else {
+		current->countFiltered();
 	}
 }
 
 template<typename ... Args>
 inline void debug(const std::string_view &msg, const Args & ... args) {
-	log(Level::debug, msg, args...);
+	if constexpr(Level::isCompiled(Level::debug)) {
+		log(Level::debug, msg, args...);
+	}
 }
 template<typename ... Args>
 inline void info(const std::string_view &msg, const Args & ... args) {
-	log(Level::info, msg, args...);
+	if constexpr(Level::isCompiled(Level::info)) {
+		log(Level::info, msg, args...);
+	}
 }
 template<typename ... Args>
 inline void note(const std::string_view &msg, const Args & ... args) {
-	log(log4hpp::Level::note, msg, args...);
+	if constexpr(Level::isCompiled(Level::note)) {
+		log(log4hpp::Level::note, msg, args...);
+	}
 }
 template<typename ... Args>
 inline void progress(const std::string_view &msg, const Args & ... args) {
-	log(Level::progress, msg, args...);
+	if constexpr(Level::isCompiled(Level::progress)) {
+		log(Level::progress, msg, args...);
+	}
 }
 template<typename ... Args>
 inline void warning(const std::string_view &msg, const Args & ... args) {
-	log(Level::warning, msg, args...);
+	if constexpr(Level::isCompiled(Level::warning)) {
+		log(Level::warning, msg, args...);
+	}
 }
 template<typename ... Args>
 inline void error(const std::string_view &msg, const Args & ... args) {
-	log(Level::error, msg, args...);
+	if constexpr(Level::isCompiled(Level::error)) {
+		log(Level::error, msg, args...);
+	}
 }
 template<typename ... Args>
 inline void fatal(const std::string_view &msg, const Args & ... args) {
-	log(Level::fatal, msg, args...);
+	if constexpr(Level::isCompiled(Level::fatal)) {
+		log(Level::fatal, msg, args...);
+	}
 }
 
 using log4hpp::makeContext;
 using log4hpp::makeDetachedContext;
+using log4hpp::makeStaticDetachedContext;
+using log4hpp::captureContext;
+using log4hpp::ContextSnapshot;
 
 
 
@@ -68,4 +90,22 @@ using log4hpp::makeDetachedContext;
 
 
 
+///Logs message, when the level is not compiled in, arguments are not evaluated
+/**
+ * @code
+ * LOG4HPP_DEBUG("Value: {}", expensiveCalculation());
+ * @endcode
+ */
+#define LOG4HPP_LOG_AT(lvl, fn, ...) do {\
+	if constexpr(::log4hpp::Level::isCompiled(::log4hpp::Level::lvl)) ::log::fn(__VA_ARGS__);\
+} while (false)
+
+#define LOG4HPP_DEBUG(...) LOG4HPP_LOG_AT(debug, debug, __VA_ARGS__)
+#define LOG4HPP_INFO(...) LOG4HPP_LOG_AT(info, info, __VA_ARGS__)
+#define LOG4HPP_NOTE(...) LOG4HPP_LOG_AT(note, note, __VA_ARGS__)
+#define LOG4HPP_PROGRESS(...) LOG4HPP_LOG_AT(progress, progress, __VA_ARGS__)
+#define LOG4HPP_WARNING(...) LOG4HPP_LOG_AT(warning, warning, __VA_ARGS__)
+#define LOG4HPP_ERROR(...) LOG4HPP_LOG_AT(error, error, __VA_ARGS__)
+#define LOG4HPP_FATAL(...) LOG4HPP_LOG_AT(fatal, fatal, __VA_ARGS__)
+
 #endif /* LOGGER_H_ */
@@ -0,0 +1,269 @@
+/*
+ * net_appender.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_NET_APPENDER_H_
+#define LOG4HPP_NET_APPENDER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+#include "record_queue.h"
+#include "stats.h"
+
+namespace log4hpp {
+
+///Sends lines to a remote collector over TCP or UDP
+/**
+ * Logging thread only copies the line to the queue, which also works as spill buffer during
+ * outages. The background thread connects, sends the lines in batches and reconnects with
+ * exponential backoff. When the queue is full, lines are dropped by the overflow policy, the caller
+ * is never blocked.
+ *
+ * TCP batches are written by a single send() under TCP_CORK, the socket has TCP_NODELAY set, so
+ * the batch leaves immediately after the cork is removed. UDP sends one datagram per line (sendmmsg())
+ *
+ * @code
+ * log4hpp::Backend<log4hpp::NetAppender> logBackend("{t} {L} {c} {m}{nl}", log4hpp::Level::info,
+ * 			"collector.local", "5140", log4hpp::NetAppender::Protocol::tcp,
+ * 			log4hpp::NetAppender::Framing::length);
+ * @endcode
+ */
+class NetAppender: public RecordSender {
+public:
+
+	enum class Protocol {
+		tcp,
+		udp
+	};
+
+	///How lines are delimited in the TCP stream (UDP sends one line per datagram)
+	enum class Framing {
+		///each line ends with '\n'
+		newline,
+		///each line is prefixed by 32bit length in network byte order (trailing newline is removed)
+		length
+	};
+
+	///Constructor
+	/**
+	 * @param host host name or address of the collector
+	 * @param service port or service name
+	 * @param protocol protocol
+	 * @param framing framing of lines (TCP)
+	 * @param queueSize size of the spill buffer in bytes
+	 * @param overflow what to do, when the spill buffer is full
+	 */
+	NetAppender(const std::string_view &host,
+			const std::string_view &service,
+			Protocol protocol = Protocol::tcp,
+			Framing framing = Framing::newline,
+			std::size_t queueSize = 4*1024*1024,
+			RecordQueue::Overflow overflow = RecordQueue::Overflow::drop_newest);
+
+	~NetAppender();
+
+	void operator()(const std::string_view &line) {
+		queue.push(line, LineInfo());
+	}
+
+	///Sends queued lines from the crash handler - async-signal-safe
+	/** Lines are sent only if the connection is established */
+	void crash_flush();
+
+	///Returns count of lines sent to the network
+	std::size_t getSent() const {return sent.load(std::memory_order_relaxed);}
+	///Returns count of bytes sent to the network (including framing)
+	std::size_t getSentBytes() const {return sentBytes.load(std::memory_order_relaxed);}
+	///Returns count of established connections
+	std::size_t getConnects() const {return connects.load(std::memory_order_relaxed);}
+
+protected:
+
+	static constexpr std::size_t maxBatch = 256;
+	static constexpr std::size_t maxBatchBytes = 256*1024;
+	static constexpr std::chrono::milliseconds minBackoff = std::chrono::milliseconds(100);
+	static constexpr std::chrono::milliseconds maxBackoff = std::chrono::milliseconds(30000);
+	static constexpr std::chrono::milliseconds ioTimeout = std::chrono::milliseconds(2000);
+
+	std::string host;
+	std::string service;
+	Protocol protocol;
+	Framing framing;
+	std::atomic<std::size_t> sent = {0};
+	std::atomic<std::size_t> sentBytes = {0};
+	std::atomic<std::size_t> connects = {0};
+
+	virtual bool connect() override;
+	virtual bool sendBatch() override {
+		return protocol == Protocol::tcp?sendTcp():sendUdp();
+	}
+	bool sendTcp();
+	bool sendUdp();
+	void frame(std::string &buff, std::string_view line) const;
+};
+
+inline NetAppender::NetAppender(const std::string_view &host, const std::string_view &service,
+		Protocol protocol, Framing framing, std::size_t queueSize, RecordQueue::Overflow overflow)
+	:RecordSender(queueSize, overflow, maxBatch, minBackoff, maxBackoff)
+	,host(host),service(service),protocol(protocol),framing(framing)
+{
+	start();
+}
+
+inline NetAppender::~NetAppender() {
+	stop();
+}
+
+inline bool NetAppender::connect() {
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = protocol == Protocol::tcp?SOCK_STREAM:SOCK_DGRAM;
+	addrinfo *res = nullptr;
+	if (getaddrinfo(host.c_str(), service.c_str(), &hints, &res)) return false;
+	int s = -1;
+	for (addrinfo *ai = res; ai && s < 0; ai = ai->ai_next) {
+		s = ::socket(ai->ai_family, ai->ai_socktype|SOCK_CLOEXEC|SOCK_NONBLOCK, ai->ai_protocol);
+		if (s < 0) continue;
+		//non-blocking connect with timeout, so the shutdown is not delayed by an unreachable host
+		if (::connect(s, ai->ai_addr, ai->ai_addrlen)) {
+			bool ok = false;
+			if (errno == EINPROGRESS) {
+				pollfd pfd = {s, POLLOUT, 0};
+				if (::poll(&pfd, 1, static_cast<int>(ioTimeout.count())) == 1) {
+					int err = 0;
+					socklen_t len = sizeof(err);
+					ok = !getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &len) && err == 0;
+				}
+			}
+			if (!ok) {
+				::close(s);
+				s = -1;
+			}
+		}
+	}
+	freeaddrinfo(res);
+	if (s < 0) return false;
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL) & ~O_NONBLOCK);
+	timeval tv = {ioTimeout.count() / 1000, (ioTimeout.count() % 1000) * 1000};
+	setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+	if (protocol == Protocol::tcp) {
+		int one = 1;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	}
+	fd.store(s);
+	++connects;
+	return true;
+}
+
+inline void NetAppender::frame(std::string &buff, std::string_view line) const {
+	line = trimLine(line);
+	if (framing == Framing::length) {
+		std::uint32_t sz = static_cast<std::uint32_t>(line.size());
+		char hdr[4] = {static_cast<char>(sz >> 24), static_cast<char>(sz >> 16),
+				static_cast<char>(sz >> 8), static_cast<char>(sz)};
+		buff.append(hdr, 4);
+		buff.append(line);
+	} else {
+		buff.append(line);
+		buff.push_back('\n');
+	}
+}
+
+inline bool NetAppender::sendTcp() {
+	//lines are joined into large writes
+	out.clear();
+	ends.clear();
+	for (std::size_t i = 0, cnt = batch.size(); i < cnt && out.size() < maxBatchBytes; i++) {
+		frame(out, batch[i].line);
+		ends.push_back(out.size());
+	}
+	int s = fd;
+	int one = 1, zero = 0;
+	std::size_t before = batch.size();
+	setsockopt(s, IPPROTO_TCP, TCP_CORK, &one, sizeof(one));
+	bool ok = sendStream(s);
+	if (ok) setsockopt(s, IPPROTO_TCP, TCP_CORK, &zero, sizeof(zero));
+	sent.fetch_add(before - batch.size(), std::memory_order_relaxed);
+	sentBytes.fetch_add(ok?out.size():outSent.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	return ok;
+}
+
+inline bool NetAppender::sendUdp() {
+	constexpr std::size_t chunk = 64;
+	mmsghdr msgs[chunk];
+	iovec iov[chunk];
+	while (!batch.empty()) {
+		std::size_t cnt = std::min(batch.size(), chunk);
+		std::size_t bytes = 0;
+		for (std::size_t i = 0; i < cnt; i++) {
+			auto line = trimLine(batch[i].line);
+			iov[i].iov_base = const_cast<char *>(line.data());
+			iov[i].iov_len = line.size();
+			msgs[i] = {};
+			msgs[i].msg_hdr.msg_iov = iov+i;
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			bytes += line.size();
+		}
+		int r = ::sendmmsg(fd, msgs, cnt, MSG_NOSIGNAL);
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			++write_errors;
+			if (errno == EMSGSIZE || errno == ECONNREFUSED) {
+				//datagram is lost (too long or nobody listens), don't reconnect
+				++dropped;
+				consume(1);
+				continue;
+			}
+			return false;
+		}
+		for (int i = 0; i < r; i++) sentBytes.fetch_add(iov[i].iov_len, std::memory_order_relaxed);
+		sent.fetch_add(r, std::memory_order_relaxed);
+		consume(r);
+	}
+	return true;
+}
+
+inline void NetAppender::crash_flush() {
+	int s = fd;
+	if (s < 0) return;
+	crash_drain(s, [&](const std::string_view &ln) {
+		auto line = trimLine(ln);
+		if (protocol == Protocol::udp) {
+			::send(s, line.data(), line.size(), MSG_NOSIGNAL);
+		} else if (framing == Framing::length) {
+			std::uint32_t sz = static_cast<std::uint32_t>(line.size());
+			char hdr[4] = {static_cast<char>(sz >> 24), static_cast<char>(sz >> 16),
+					static_cast<char>(sz >> 8), static_cast<char>(sz)};
+			sendAll(s, hdr, 4);
+			sendAll(s, line.data(), line.size());
+		} else {
+			sendAll(s, line.data(), line.size());
+			sendAll(s, "\n", 1);
+		}
+	});
+}
+
+}
+
+
+
+#endif /* LOG4HPP_NET_APPENDER_H_ */
@@ -0,0 +1,504 @@
+/*
+ * record_queue.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_RECORD_QUEUE_H_
+#define LOG4HPP_RECORD_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "appender.h"
+#include "stats.h"
+
+namespace log4hpp {
+
+///Bounded queue of lines between logging threads and a background writer of an appender
+/**
+ * Lines are copied into a preallocated circular buffer (no allocation per line). When the buffer
+ * is full, the overflow policy is applied. The writer thread moves lines in batches to
+ * a RecordBatch and processes them without holding the lock.
+ */
+class RecordQueue {
+public:
+
+	///What to do, when the queue is full
+	enum class Overflow {
+		///new line is dropped
+		drop_newest,
+		///the oldest lines are dropped to make space for the new line
+		drop_oldest,
+		///new line is dropped if its level is more verbose than the drop level, otherwise
+		///the oldest lines are dropped
+		drop_below_level,
+		///caller waits for space (with timeout), then the new line is dropped
+		block
+	};
+
+	///Line in the queue
+	struct Record {
+		std::string_view line;
+		LineInfo info;
+		///time when the line was queued
+		std::chrono::system_clock::time_point time;
+	};
+
+	///Batch of lines taken from the queue
+	class Batch {
+	public:
+		std::size_t size() const {return entries.size();}
+		bool empty() const {return entries.empty();}
+		void clear() {entries.clear();data.clear();}
+		Record operator[](std::size_t idx) const {
+			const Entry &e = entries[idx];
+			return Record{std::string_view(data.data()+e.offset, e.size), e.info, e.time};
+		}
+		///Removes first n records (which were processed)
+		void consume(std::size_t n) {
+			if (n >= entries.size()) clear();
+			else entries.erase(entries.begin(), entries.begin()+n);
+		}
+	protected:
+		struct Entry {
+			std::size_t offset;
+			std::size_t size;
+			LineInfo info;
+			std::chrono::system_clock::time_point time;
+		};
+		std::vector<char> data;
+		std::vector<Entry> entries;
+		friend class RecordQueue;
+	};
+
+	///Construct the queue
+	/**
+	 * @param capacity capacity in bytes
+	 * @param overflow overflow policy
+	 * @param dropLevel level for Overflow::drop_below_level
+	 * @param blockTimeout timeout for Overflow::block
+	 */
+	RecordQueue(std::size_t capacity, Overflow overflow = Overflow::drop_newest,
+			Level::Type dropLevel = Level::warning,
+			std::chrono::milliseconds blockTimeout = std::chrono::milliseconds(100))
+		:buffer(capacity < 4096?4096:capacity),overflow(overflow)
+		,dropLevel(dropLevel),blockTimeout(blockTimeout) {}
+
+	///Pushes line to the queue
+	/**
+	 * @retval true line queued
+	 * @retval false line dropped
+	 */
+	bool push(const std::string_view &line, const LineInfo &info);
+
+	///Takes lines from the queue
+	/**
+	 * @param batch batch, lines are appended
+	 * @param maxRecords maximum count of lines
+	 * @param timeout how long to wait, if the queue is empty
+	 * @retval true lines are available (or timeout)
+	 * @retval false queue is closed and empty
+	 */
+	bool pop(Batch &batch, std::size_t maxRecords, std::chrono::milliseconds timeout);
+
+	///Closes the queue, wakes the writer
+	void close() {
+		std::lock_guard _(lock);
+		closed = true;
+		cond.notify_all();
+		spaceCond.notify_all();
+	}
+
+	///Wakes the writer
+	void notify() {
+		cond.notify_all();
+	}
+
+	///Count of lines in the queue
+	std::size_t size() const {return count.load(std::memory_order_relaxed);}
+	///Count of dropped lines
+	std::size_t dropped() const {return dropCount.load(std::memory_order_relaxed);}
+
+	///Reads lines without locking (from the crash handler)
+	/** Function is async-signal-safe as long as the callback is async-signal-safe. The result
+	 * may be inconsistent, if the queue is modified at the same time. Lines longer than 4096 bytes
+	 * are truncated */
+	template<typename Fn>
+	void crash_drain(Fn &&fn);
+
+protected:
+
+	struct Hdr {
+		std::uint32_t size;
+		LineInfo info;
+		std::chrono::system_clock::time_point time;
+	};
+
+	std::vector<char> buffer;
+	Overflow overflow;
+	Level::Type dropLevel;
+	std::chrono::milliseconds blockTimeout;
+	std::mutex lock;
+	std::condition_variable cond;
+	std::condition_variable spaceCond;
+	unsigned int spaceWaiters = 0;
+	std::size_t head = 0;	//write position (monotonic)
+	std::size_t tail = 0;	//read position (monotonic)
+	std::atomic<std::size_t> count = {0};
+	std::atomic<std::size_t> dropCount = {0};
+	bool closed = false;
+
+	void copyIn(std::size_t pos, const void *data, std::size_t sz) {
+		std::size_t off = pos % buffer.size();
+		std::size_t part = std::min(sz, buffer.size() - off);
+		std::memcpy(buffer.data()+off, data, part);
+		std::memcpy(buffer.data(), reinterpret_cast<const char *>(data)+part, sz - part);
+	}
+	void copyOut(std::size_t pos, void *data, std::size_t sz) const {
+		std::size_t off = pos % buffer.size();
+		std::size_t part = std::min(sz, buffer.size() - off);
+		std::memcpy(data, buffer.data()+off, part);
+		std::memcpy(reinterpret_cast<char *>(data)+part, buffer.data(), sz - part);
+	}
+	void dropOldest() {
+		Hdr h;
+		copyOut(tail, &h, sizeof(h));
+		tail += sizeof(h) + h.size;
+		count.fetch_sub(1, std::memory_order_relaxed);
+		dropCount.fetch_add(1, std::memory_order_relaxed);
+	}
+};
+
+inline bool RecordQueue::push(const std::string_view &line, const LineInfo &info) {
+	std::size_t need = sizeof(Hdr) + line.size();
+	if (need > buffer.size()) {
+		dropCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	//time of the event captured at the call site (if known), not the time of enqueue
+	auto time = info.time?std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+			std::chrono::nanoseconds(info.time))):std::chrono::system_clock::now();
+	Hdr h{static_cast<std::uint32_t>(line.size()), info, time};
+	std::unique_lock _(lock);
+	auto full = [&]{return head - tail + need > buffer.size();};
+	if (full()) {
+		switch (overflow) {
+			case Overflow::drop_oldest:
+				break;
+			case Overflow::drop_below_level:
+				if (info.level <= dropLevel) break;
+				dropCount.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			case Overflow::block:
+				++spaceWaiters;
+				spaceCond.wait_for(_, blockTimeout, [&]{return !full() || closed;});
+				--spaceWaiters;
+				if (!full()) break;
+				[[fallthrough]];
+			default:
+				dropCount.fetch_add(1, std::memory_order_relaxed);
+				return false;
+		}
+		while (full()) dropOldest();
+	}
+	copyIn(head, &h, sizeof(h));
+	copyIn(head+sizeof(h), line.data(), line.size());
+	head += need;
+	bool wasEmpty = count.fetch_add(1, std::memory_order_relaxed) == 0;
+	_.unlock();
+	if (wasEmpty) cond.notify_one();
+	return true;
+}
+
+inline bool RecordQueue::pop(Batch &batch, std::size_t maxRecords, std::chrono::milliseconds timeout) {
+	std::unique_lock _(lock);
+	if (head == tail) {
+		if (closed) return false;
+		cond.wait_for(_, timeout, [&]{return head != tail || closed;});
+	}
+	std::size_t n = 0;
+	while (head != tail && n < maxRecords) {
+		Hdr h;
+		copyOut(tail, &h, sizeof(h));
+		std::size_t offset = batch.data.size();
+		batch.data.resize(offset + h.size);
+		copyOut(tail+sizeof(h), batch.data.data()+offset, h.size);
+		batch.entries.push_back(Batch::Entry{offset, h.size, h.info, h.time});
+		tail += sizeof(h) + h.size;
+		++n;
+	}
+	count.fetch_sub(n, std::memory_order_relaxed);
+	if (n && spaceWaiters) spaceCond.notify_all();
+	return true;
+}
+
+template<typename Fn>
+inline void RecordQueue::crash_drain(Fn &&fn) {
+	char line[4096];
+	std::size_t t = tail;
+	std::size_t h = head;
+	while (t < h) {
+		Hdr hdr;
+		copyOut(t, &hdr, sizeof(hdr));
+		if (hdr.size > buffer.size()) break;
+		std::size_t sz = std::min<std::size_t>(hdr.size, sizeof(line));
+		copyOut(t+sizeof(hdr), line, sz);
+		fn(std::string_view(line, sz), hdr.info);
+		t += sizeof(hdr) + hdr.size;
+	}
+	tail = t;
+}
+
+///Background sender of queued lines to a socket (base of the socket appenders)
+/**
+ * Logging threads only push lines to the queue. The worker thread takes lines in batches and
+ * passes them to sendBatch(). When the connection is not available or sending fails, the worker
+ * reconnects with exponential backoff, the lines are kept in the queue (until it is full). During
+ * shutdown the rest of the queue gets one more attempt, lines which can't be sent are counted as dropped.
+ *
+ * Derived class implements connect() and sendBatch() (framing of the lines). It must call start()
+ * at the end of its constructor and stop() at the beginning of its destructor.
+ */
+class RecordSender {
+public:
+
+	///Adds counters of the appender to the statistics
+	void stats(BackendStats &st) const {
+		st.dropped += queue.dropped() + dropped.load(std::memory_order_relaxed);
+		st.write_errors += write_errors.load(std::memory_order_relaxed);
+		st.queue_depth += queue.size();
+	}
+
+	///Returns true, if the appender is connected
+	bool isConnected() const {return fd >= 0;}
+
+protected:
+
+	///Construct the sender
+	/**
+	 * @param queueSize size of the queue in bytes
+	 * @param overflow what to do, when the queue is full
+	 * @param maxBatch maximum count of lines passed to sendBatch()
+	 * @param minBackoff delay before the first reconnect
+	 * @param maxBackoff maximum delay between reconnects
+	 */
+	RecordSender(std::size_t queueSize, RecordQueue::Overflow overflow, std::size_t maxBatch,
+			std::chrono::milliseconds minBackoff, std::chrono::milliseconds maxBackoff)
+		:queue(queueSize, overflow),maxBatch(maxBatch),minBackoff(minBackoff),maxBackoff(maxBackoff) {}
+	virtual ~RecordSender() {stop();}
+
+	RecordSender(const RecordSender &) = delete;
+	RecordSender &operator=(const RecordSender &) = delete;
+
+	///Opens the connection, stores the socket to the fd
+	virtual bool connect() = 0;
+	///Sends lines from the batch, removes sent lines from the batch
+	/** @retval false connection failed */
+	virtual bool sendBatch() = 0;
+
+	///Starts the worker thread
+	void start();
+	///Stops the worker thread, sends the rest of the queue
+	void stop();
+	void disconnect() {
+		int s = fd.exchange(-1);
+		if (s >= 0) ::close(s);
+	}
+	bool isStopping() {
+		std::lock_guard _(stopLock);
+		return stopping;
+	}
+
+	///Sends the stream buffer (out), removes the sent lines from the batch
+	/**
+	 * Ends of lines in the buffer are in `ends`, lines are removed from the batch only when
+	 * they were sent completely, so the partially sent line is sent again after reconnect.
+	 * Progress is published for crash_drain()
+	 *
+	 * @param s socket
+	 * @retval false connection failed
+	 */
+	bool sendStream(int s);
+
+	///Marks count of lines at the beginning of the batch, which were already sent
+	void batchProgress(std::size_t n) {batchSent.store(n, std::memory_order_release);}
+
+	///Removes sent lines from the batch
+	void consume(std::size_t n) {
+		batchSent.store(0, std::memory_order_relaxed);
+		batch.consume(n);
+	}
+
+	///Sends pending data from the crash handler - async-signal-safe
+	/**
+	 * Frame in progress of the stream socket is finished first, so crash lines don't interleave
+	 * into it (when the socket is not available, the frame is dropped). Then lines of the batch
+	 * which were not sent and lines of the queue are passed to the function.
+	 *
+	 * @param s socket (-1 if not connected)
+	 * @param fn function which writes the line - fn(std::string_view)
+	 */
+	template<typename Fn>
+	void crash_drain(int s, Fn &&fn);
+
+	static std::string_view trimLine(std::string_view line) {
+		while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line = line.substr(0, line.size()-1);
+		return line;
+	}
+	///Writes whole buffer to the socket - async-signal-safe
+	static bool sendAll(int s, const char *data, std::size_t size);
+	///Writes whole buffer to a file descriptor (not a socket) - async-signal-safe
+	static bool writeAll(int f, const char *data, std::size_t size);
+
+	RecordQueue queue;
+	std::atomic<int> fd = {-1};
+	std::atomic<std::size_t> dropped = {0};
+	std::atomic<std::size_t> write_errors = {0};
+
+	///lines taken from the queue (worker thread)
+	RecordQueue::Batch batch;
+	///framed lines of the batch for the stream socket
+	std::string out;
+	///ends of the lines in the out
+	std::vector<std::size_t> ends;
+	///bytes of the out, which were sent (read by the crash handler)
+	std::atomic<std::size_t> outSent = {0};
+	///size of the out being sent, 0 if there is no stream send in progress (read by the crash handler)
+	std::atomic<std::size_t> outSize = {0};
+
+private:
+	std::size_t maxBatch;
+	std::chrono::milliseconds minBackoff;
+	std::chrono::milliseconds maxBackoff;
+	///lines of the batch which are already sent or which are in the out
+	std::atomic<std::size_t> batchSent = {0};
+
+	std::mutex stopLock;
+	std::condition_variable stopCond;
+	bool stopping = false;
+	std::thread worker;
+
+	void run();
+};
+
+inline void RecordSender::start() {
+	worker = std::thread([this]{run();});
+}
+
+inline void RecordSender::stop() {
+	if (!worker.joinable()) return;
+	{
+		std::lock_guard _(stopLock);
+		stopping = true;
+	}
+	stopCond.notify_all();
+	queue.close();
+	worker.join();
+	disconnect();
+}
+
+inline void RecordSender::run() {
+	auto backoff = minBackoff;
+	bool closed = false;
+	while (true) {
+		if (fd < 0 && !connect()) {
+			++write_errors;
+			if (closed) break;
+			std::unique_lock lk(stopLock);
+			if (stopCond.wait_for(lk, backoff, [&]{return stopping;})) {
+				//one more attempt to deliver the rest of the queue
+				closed = true;
+				continue;
+			}
+			backoff = std::min(backoff * 2, maxBackoff);
+			continue;
+		}
+		backoff = minBackoff;
+		if (batch.empty() && !queue.pop(batch, maxBatch, std::chrono::milliseconds(1000))) break;
+		if (batch.empty()) continue;
+		if (!sendBatch()) {
+			disconnect();
+			//don't wait for a stuck peer during shutdown
+			if (isStopping()) break;
+		}
+	}
+	dropped.fetch_add(batch.size() + queue.size(), std::memory_order_relaxed);
+}
+
+inline bool RecordSender::sendStream(int s) {
+	outSent.store(0, std::memory_order_relaxed);
+	outSize.store(out.size(), std::memory_order_relaxed);
+	batchProgress(ends.size());
+	std::size_t pos = 0;
+	bool ok = true;
+	while (pos < out.size()) {
+		auto r = ::send(s, out.data()+pos, out.size()-pos, MSG_NOSIGNAL);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) {
+			++write_errors;
+			ok = false;
+			break;
+		}
+		pos += r;
+		outSent.store(pos, std::memory_order_release);
+	}
+	outSize.store(0, std::memory_order_release);
+	consume(std::upper_bound(ends.begin(), ends.end(), pos) - ends.begin());
+	return ok;
+}
+
+template<typename Fn>
+inline void RecordSender::crash_drain(int s, Fn &&fn) {
+	std::size_t sz = outSize.load(std::memory_order_acquire);
+	std::size_t pos = outSent.load(std::memory_order_acquire);
+	if (s >= 0 && pos < sz) sendAll(s, out.data()+pos, sz-pos);
+	std::size_t n = batch.size();
+	for (std::size_t i = batchSent.load(std::memory_order_acquire); i < n; i++) {
+		fn(batch[i].line);
+	}
+	queue.crash_drain([&](const std::string_view &line, const LineInfo &) {
+		fn(line);
+	});
+}
+
+inline bool RecordSender::sendAll(int s, const char *data, std::size_t size) {
+	while (size) {
+		auto r = ::send(s, data, size, MSG_NOSIGNAL);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) return false;
+		data += r;
+		size -= r;
+	}
+	return true;
+}
+
+inline bool RecordSender::writeAll(int f, const char *data, std::size_t size) {
+	while (size) {
+		auto r = ::write(f, data, size);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) return false;
+		data += r;
+		size -= r;
+	}
+	return true;
+}
+
+}
+
+
+
+#endif /* LOG4HPP_RECORD_QUEUE_H_ */
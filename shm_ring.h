@@ -0,0 +1,396 @@
+/*
+ * shm_ring.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_SHM_RING_H_
+#define LOG4HPP_SHM_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace log4hpp {
+
+///Lock-free ring buffer of records in POSIX shared memory
+/**
+ * The ring connects one producer process (can have many threads) with one consumer process.
+ * Producers reserve space by CAS on the head, copy the record and commit it by writing its
+ * header. The consumer reads committed records, clears the space and moves the tail. Producers
+ * never block in the kernel, unless Policy::block is selected and the ring is full.
+ *
+ * Crash handling
+ * - committed records survive crash of the producer, the consumer drains them
+ * - records reserved but not committed by a dead producer are discarded (counted as lost), committed
+ *   records after them are still delivered
+ * - the consumer can be restarted, it continues where the previous one stopped
+ * - when the consumer is dead, producers don't wait for free space
+ *
+ * Layout: header (one page) followed by data area (capacity bytes, power of two). Records are
+ * aligned to 8 bytes. Record header is 32bit: (length << 3) | flags, where bit0 means committed,
+ * bit1 means padding to the end of the data area and bit2 means that the space is reserved (the length
+ * is valid, the record is not committed yet). Zero means the header was not written yet.
+ */
+class ShmRing {
+public:
+
+	///What to do when the ring is full
+	enum class Policy {
+		///drop the record (it is counted)
+		drop,
+		///wait for free space (with timeout), then drop the record
+		block
+	};
+
+	enum class Role {
+		producer,
+		consumer
+	};
+
+	///Opens or creates the ring
+	/**
+	 * @param name name of the shared memory object (starting by '/')
+	 * @param role role of this process. There can be only one living producer and one living consumer
+	 * @param capacity capacity of the data area in bytes, rounded up to the power of two. It is used
+	 * only when the ring is created, otherwise the capacity of the existing ring is used
+	 *
+	 * @exception std::system_error unable to open the ring or the role is taken by an another process
+	 */
+	ShmRing(const std::string_view &name, Role role, std::size_t capacity = 4*1024*1024);
+	~ShmRing();
+
+	ShmRing(const ShmRing &) = delete;
+	ShmRing &operator=(const ShmRing &) = delete;
+
+	///Pushes record to the ring (producer)
+	/**
+	 * @param data content of the record
+	 * @param policy what to do when the ring is full
+	 * @param timeout timeout for Policy::block
+	 * @retval true record pushed
+	 * @retval false record dropped
+	 *
+	 * @note with Policy::drop, the function is async-signal-safe
+	 */
+	bool push(const std::string_view &data, Policy policy = Policy::drop,
+			std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+	///Reads committed records (consumer)
+	/**
+	 * @param fn function called for every record - fn(std::string_view)
+	 * @param limit maximum count of records
+	 * @return count of records processed
+	 */
+	template<typename Fn>
+	std::size_t drain(Fn &&fn, std::size_t limit = static_cast<std::size_t>(-1));
+
+	///Returns true, if the process with given role is alive
+	bool isAlive(Role role) const;
+
+	///Count of records dropped by producers (ring was full)
+	std::uint64_t getDropped() const {return hdr->dropped.load(std::memory_order_relaxed);}
+	///Count of incomplete records discarded after producer's crash
+	/** Each reserved record is counted. When the producer died before it wrote the header of the
+	 * reservation, the rest of its reserved space is skipped and counted as one record */
+	std::uint64_t getLost() const {return hdr->lost.load(std::memory_order_relaxed);}
+	///Count of records consumed
+	std::uint64_t getConsumed() const {return hdr->consumed.load(std::memory_order_relaxed);}
+	///Count of records waiting in the ring (all producers)
+	std::uint64_t getDepth() const {
+		std::uint64_t c = hdr->consumed.load(std::memory_order_relaxed);
+		std::uint64_t p = hdr->committed.load(std::memory_order_relaxed);
+		return p > c?p - c:0;
+	}
+	///Count of bytes waiting in the ring
+	std::size_t getPending() const {
+		return hdr->head.load(std::memory_order_relaxed) - hdr->tail.load(std::memory_order_relaxed);
+	}
+	///Capacity of data area
+	std::size_t getCapacity() const {return capacity;}
+
+	///Removes the shared memory object (the ring remains mapped for processes which have it opened)
+	static void unlink(const std::string_view &name) {
+		::shm_unlink(std::string(name).c_str());
+	}
+
+protected:
+
+	static constexpr std::uint32_t magic = 0x5248344C; //"L4HR"
+	static constexpr std::uint32_t version = 2;
+	static constexpr std::size_t headerSize = 4096;
+	static constexpr std::uint32_t flagCommit = 1;
+	static constexpr std::uint32_t flagPad = 2;
+	static constexpr std::uint32_t flagReserved = 4;
+	static constexpr unsigned int lengthShift = 3;
+
+	struct Header {
+		std::atomic<std::uint32_t> magic;
+		std::uint32_t version;
+		std::uint64_t capacity;
+		alignas(64) std::atomic<std::uint64_t> head;
+		///count of records committed by producers (shares the cache line with the head)
+		std::atomic<std::uint64_t> committed;
+		alignas(64) std::atomic<std::uint64_t> tail;
+		///consumer cleans space up to this position before it moves the tail
+		std::atomic<std::uint64_t> cleaning;
+		///records before this position were reserved by a dead producer
+		std::atomic<std::uint64_t> abandoned;
+		std::atomic<std::uint64_t> consumed;
+		alignas(64) std::atomic<std::int32_t> producer_pid;
+		std::atomic<std::int32_t> consumer_pid;
+		std::atomic<std::uint64_t> dropped;
+		std::atomic<std::uint64_t> lost;
+	};
+
+	using AtomicHdr = std::atomic<std::uint32_t>;
+	static_assert(sizeof(Header) <= headerSize, "Header is too large");
+	static_assert(sizeof(AtomicHdr) == sizeof(std::uint32_t) && AtomicHdr::is_always_lock_free,
+			"Unsupported platform");
+
+	Role role;
+	int fd = -1;
+	void *map = MAP_FAILED;
+	std::size_t mapSize = 0;
+	Header *hdr = nullptr;
+	char *data = nullptr;
+	std::size_t capacity = 0;
+
+	void close_ring();
+	static std::size_t align8(std::size_t sz) {return (sz + 7) & ~std::size_t(7);}
+	static bool pidAlive(std::int32_t pid) {
+		return pid > 0 && (::kill(pid, 0) == 0 || errno != ESRCH);
+	}
+	AtomicHdr &recordHdr(std::uint64_t pos) const {
+		return *reinterpret_cast<AtomicHdr *>(data + (pos & (capacity-1)));
+	}
+	void clean(std::uint64_t from, std::uint64_t to) {
+		while (from < to) {
+			std::size_t off = from & (capacity - 1);
+			std::size_t sz = std::min<std::uint64_t>(to - from, capacity - off);
+			std::memset(data+off, 0, sz);
+			from += sz;
+		}
+	}
+	void release(std::uint64_t to) {
+		hdr->cleaning.store(to, std::memory_order_relaxed);
+		clean(hdr->tail.load(std::memory_order_relaxed), to);
+		hdr->tail.store(to, std::memory_order_release);
+	}
+	[[noreturn]] static void error(const std::string_view &name, const char *what, int e) {
+		std::string msg(what);
+		msg.append(name);
+		throw std::system_error(e, std::system_category(), msg);
+	}
+};
+
+inline ShmRing::ShmRing(const std::string_view &name, Role role, std::size_t capacity):role(role) {
+	std::string sname(name);
+	std::size_t cap = 4096;
+	while (cap < capacity) cap <<= 1;
+
+	bool created = true;
+	fd = ::shm_open(sname.c_str(), O_RDWR|O_CREAT|O_EXCL|O_CLOEXEC, 0600);
+	if (fd < 0 && errno == EEXIST) {
+		created = false;
+		fd = ::shm_open(sname.c_str(), O_RDWR|O_CLOEXEC, 0600);
+	}
+	if (fd < 0) error(name, "Can't open shared memory ring: ", errno);
+	if (created) {
+		if (::ftruncate(fd, headerSize + cap)) {
+			int e = errno;
+			::close(fd);
+			::shm_unlink(sname.c_str());
+			error(name, "Can't resize shared memory ring: ", e);
+		}
+	} else {
+		//wait for the creator to resize the object
+		struct stat st;
+		for (int i = 0; i < 1000; i++) {
+			if (::fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) > headerSize) break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) <= headerSize) {
+			::close(fd);
+			error(name, "Shared memory ring is not initialized: ", EINVAL);
+		}
+		cap = st.st_size - headerSize;
+	}
+	mapSize = headerSize + cap;
+	map = ::mmap(nullptr, mapSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		int e = errno;
+		::close(fd);
+		error(name, "Can't map shared memory ring: ", e);
+	}
+	hdr = reinterpret_cast<Header *>(map);
+	data = reinterpret_cast<char *>(map) + headerSize;
+	this->capacity = cap;
+
+	if (created) {
+		//the object is zeroed by ftruncate, counters are zero
+		hdr->version = version;
+		hdr->capacity = cap;
+		hdr->magic.store(magic, std::memory_order_release);
+	} else {
+		for (int i = 0; i < 1000 && hdr->magic.load(std::memory_order_acquire) != magic; i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		if (hdr->magic.load(std::memory_order_acquire) != magic || hdr->version != version
+				|| hdr->capacity != cap || (cap & (cap-1)) != 0) {
+			close_ring();
+			error(name, "Incompatible shared memory ring: ", EINVAL);
+		}
+	}
+
+	std::int32_t self = ::getpid();
+	auto &pid = role == Role::producer?hdr->producer_pid:hdr->consumer_pid;
+	std::int32_t prev = pid.load(std::memory_order_acquire);
+	do {
+		if (prev != self && pidAlive(prev)) {
+			close_ring();
+			error(name, "Shared memory ring is used by an another process: ", EBUSY);
+		}
+	} while (!pid.compare_exchange_weak(prev, self, std::memory_order_acq_rel));
+	if (role == Role::producer) {
+		//records not committed by the previous producer will never be committed
+		hdr->abandoned.store(hdr->head.load(std::memory_order_acquire), std::memory_order_release);
+	} else {
+		//finish the cleaning interrupted by the crash of the previous consumer
+		auto cl = hdr->cleaning.load(std::memory_order_relaxed);
+		if (cl > hdr->tail.load(std::memory_order_relaxed)) release(cl);
+	}
+}
+
+inline ShmRing::~ShmRing() {
+	close_ring();
+}
+
+inline void ShmRing::close_ring() {
+	if (hdr) {
+		auto &pid = role == Role::producer?hdr->producer_pid:hdr->consumer_pid;
+		std::int32_t self = ::getpid();
+		pid.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+		hdr = nullptr;
+	}
+	if (map != MAP_FAILED) {
+		::munmap(map, mapSize);
+		map = MAP_FAILED;
+	}
+	if (fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+}
+
+inline bool ShmRing::isAlive(Role role) const {
+	return pidAlive((role == Role::producer?hdr->producer_pid:hdr->consumer_pid).load(std::memory_order_relaxed));
+}
+
+inline bool ShmRing::push(const std::string_view &rec, Policy policy, std::chrono::milliseconds timeout) {
+	std::size_t need = align8(sizeof(std::uint32_t) + rec.size());
+	if (need > capacity/4 || rec.size() >= (1U<<(32-lengthShift))) {
+		hdr->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	std::uint64_t h = hdr->head.load(std::memory_order_relaxed);
+	std::uint64_t pad;
+	std::chrono::steady_clock::time_point deadline;
+	bool waiting = false;
+	while (true) {
+		std::uint64_t t = hdr->tail.load(std::memory_order_acquire);
+		std::size_t off = h & (capacity-1);
+		pad = off + need > capacity?capacity - off:0;
+		if (h + pad + need - t > capacity) {
+			if (policy == Policy::drop || !isAlive(Role::consumer)) {
+				hdr->dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			auto now = std::chrono::steady_clock::now();
+			if (!waiting) {
+				deadline = now + timeout;
+				waiting = true;
+			} else if (now >= deadline) {
+				hdr->dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+			h = hdr->head.load(std::memory_order_relaxed);
+			continue;
+		}
+		if (hdr->head.compare_exchange_weak(h, h + pad + need, std::memory_order_acq_rel)) break;
+	}
+	if (pad) {
+		recordHdr(h).store(static_cast<std::uint32_t>(pad << lengthShift) | flagPad | flagCommit, std::memory_order_release);
+		h += pad;
+	}
+	//the length is published first, so the consumer can skip the record, if this process dies
+	std::uint32_t rh = static_cast<std::uint32_t>(rec.size() << lengthShift) | flagReserved;
+	recordHdr(h).store(rh, std::memory_order_relaxed);
+	std::memcpy(data + (h & (capacity-1)) + sizeof(std::uint32_t), rec.data(), rec.size());
+	hdr->committed.fetch_add(1, std::memory_order_relaxed);
+	recordHdr(h).store(rh | flagCommit, std::memory_order_release);
+	return true;
+}
+
+template<typename Fn>
+inline std::size_t ShmRing::drain(Fn &&fn, std::size_t limit) {
+	std::size_t cnt = 0;
+	std::uint64_t t = hdr->tail.load(std::memory_order_relaxed);
+	std::uint64_t start = t;
+	std::uint64_t h = hdr->head.load(std::memory_order_acquire);
+	while (t < h && cnt < limit) {
+		std::uint32_t rh = recordHdr(t).load(std::memory_order_acquire);
+		if (!(rh & flagCommit)) {
+			//not committed - either being written or abandoned by a dead producer
+			std::uint64_t ab = hdr->abandoned.load(std::memory_order_acquire);
+			if (t >= ab) {
+				if (isAlive(Role::producer)) break;
+				hdr->abandoned.store(h, std::memory_order_release);
+				ab = h;
+			}
+			hdr->lost.fetch_add(1, std::memory_order_relaxed);
+			if (rh & flagReserved) {
+				//length is known, continue by the next record
+				t += align8(sizeof(std::uint32_t) + (rh >> lengthShift));
+			} else {
+				//producer died before it wrote the header, records behind can't be located
+				t = ab;
+			}
+			continue;
+		}
+		if (rh & flagPad) {
+			t += rh >> lengthShift;
+			continue;
+		}
+		std::size_t len = rh >> lengthShift;
+		fn(std::string_view(data + (t & (capacity-1)) + sizeof(std::uint32_t), len));
+		t += align8(sizeof(std::uint32_t) + len);
+		++cnt;
+	}
+	if (t != start) {
+		hdr->consumed.fetch_add(cnt, std::memory_order_relaxed);
+		release(t);
+	}
+	return cnt;
+}
+
+}
+
+
+
+#endif /* LOG4HPP_SHM_RING_H_ */
@@ -0,0 +1,78 @@
+/*
+ * shm_ring_appender.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_SHM_RING_APPENDER_H_
+#define LOG4HPP_SHM_RING_APPENDER_H_
+
+#include <atomic>
+#include <chrono>
+
+#include "shm_ring.h"
+#include "stats.h"
+
+namespace log4hpp {
+
+///Sends lines to the shared memory ring, which is drained by the log4hpp-collector process
+/**
+ * The logging thread only copies the line to the shared memory, the I/O is performed by
+ * the collector.
+ *
+ * @code
+ * log4hpp::Backend<log4hpp::ShmRingAppender> logBackend("{t} {L} {m}{nl}", log4hpp::Level::debug,
+ * 			"/myservice-log", 16*1024*1024);
+ * @endcode
+ *
+ * collector:  log4hpp-collector /myservice-log log/logfile
+ */
+class ShmRingAppender {
+public:
+
+	///Constructor
+	/**
+	 * @param name name of the shared memory object (starting by '/')
+	 * @param capacity capacity of the ring in bytes (if the ring is created)
+	 * @param policy what to do when the ring is full
+	 * @param timeout timeout for ShmRing::Policy::block
+	 */
+	ShmRingAppender(const std::string_view &name, std::size_t capacity = 4*1024*1024,
+			ShmRing::Policy policy = ShmRing::Policy::drop,
+			std::chrono::milliseconds timeout = std::chrono::milliseconds(100))
+		:ring(name, ShmRing::Role::producer, capacity),policy(policy),timeout(timeout) {}
+
+	void operator()(const std::string_view &line) {
+		if (!ring.push(line, policy, timeout)) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	///Writes line from the crash handler - async-signal-safe
+	void crash_write(const std::string_view &line) {
+		ring.push(line, ShmRing::Policy::drop);
+	}
+
+	///Adds counters of the appender to the statistics
+	void stats(BackendStats &st) const {
+		st.dropped += dropped.load(std::memory_order_relaxed);
+		//depth of the ring - includes records of previous producers, which are not consumed yet
+		st.queue_depth += ring.getDepth();
+	}
+
+	///Returns true, if the collector is running
+	bool isCollectorAlive() const {return ring.isAlive(ShmRing::Role::consumer);}
+
+protected:
+	ShmRing ring;
+	ShmRing::Policy policy;
+	std::chrono::milliseconds timeout;
+	std::atomic<std::size_t> dropped = {0};
+};
+
+}
+
+
+
+#endif /* LOG4HPP_SHM_RING_APPENDER_H_ */
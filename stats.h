@@ -0,0 +1,169 @@
+/*
+ * stats.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_STATS_H_
+#define LOG4HPP_STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include "format.h"
+
+namespace log4hpp {
+
+///Snapshot of backend statistics
+struct BackendStats {
+	///count of buckets of the latency histogram
+	static constexpr unsigned int histogram_size = 32;
+
+	///messages sent to the appender
+	std::size_t accepted = 0;
+	///messages rejected by the level - by the level of the thread at the call site (all threads, shared
+	///by all backends) or by the backend level (messages let through for the flight recorder or a context level)
+	std::size_t filtered = 0;
+	///messages dropped by the appender (errors, full queues)
+	std::size_t dropped = 0;
+	///bytes sent to the appender
+	std::size_t bytes = 0;
+	///count of calls of the appender
+	std::size_t writes = 0;
+	///count of failed writes reported by the appender
+	std::size_t write_errors = 0;
+	///count of messages waiting in the queue of the appender (if applicable)
+	std::size_t queue_depth = 0;
+	///count of threads with logging state (all backends)
+	std::size_t threads = 0;
+	///memory allocated by logging buffers of all threads (all backends)
+	std::size_t thread_memory = 0;
+	///histogram of appender write latency.
+	/** Bucket n counts writes which took less than 2^n nanoseconds (and at least 2^(n-1)), the
+	 * last bucket counts all longer writes. Only sampled writes are measured (see
+	 * BackendT::setLatencySampling) */
+	std::size_t latency[histogram_size] = {};
+
+	///Returns upper bound of the latency percentile in nanoseconds
+	/**
+	 * @param p percentile (0.5, 0.99, ...)
+	 * @return upper bound of the bucket, where the percentile lies
+	 */
+	std::size_t latencyPercentile(double p) const {
+		std::size_t total = 0;
+		for (auto c: latency) total += c;
+		if (total == 0) return 0;
+		std::size_t limit = static_cast<std::size_t>(p * total);
+		std::size_t sum = 0;
+		for (unsigned int i = 0; i < histogram_size; i++) {
+			sum += latency[i];
+			if (sum > limit) return std::size_t(1) << i;
+		}
+		return std::size_t(1) << (histogram_size-1);
+	}
+
+	///Returns bucket index for given duration in nanoseconds
+	static unsigned int latencyBucket(std::size_t ns) {
+		unsigned int b = 0;
+		while (ns && b < histogram_size-1) {ns>>=1;++b;}
+		return b;
+	}
+};
+
+///Lock-free counters, sharded by thread
+class StatsCounters {
+public:
+
+	///count of shards
+	static constexpr unsigned int shards = 16;
+
+	struct alignas(64) Shard {
+		std::atomic<std::size_t> accepted = {0};
+		std::atomic<std::size_t> filtered = {0};
+		std::atomic<std::size_t> dropped = {0};
+		std::atomic<std::size_t> bytes = {0};
+		std::atomic<std::size_t> writes = {0};
+		std::atomic<std::size_t> write_errors = {0};
+		std::atomic<std::size_t> latency[BackendStats::histogram_size] = {};
+
+		static void inc(std::atomic<std::size_t> &v, std::size_t n = 1) {
+			v.fetch_add(n, std::memory_order_relaxed);
+		}
+		///Records write to the appender
+		/**
+		 * @param sz size of the line
+		 * @param sampleMask the write is measured, when its number masked by the mask is zero
+		 * @return true, if the write should be measured
+		 */
+		bool write(std::size_t sz, std::size_t sampleMask) {
+			std::size_t n = writes.fetch_add(1, std::memory_order_relaxed);
+			inc(bytes, sz);
+			return (n & sampleMask) == 0;
+		}
+		///Records duration of the measured write
+		void measured(std::chrono::steady_clock::duration dur) {
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
+			inc(latency[BackendStats::latencyBucket(ns>0?ns:0)]);
+		}
+	};
+
+	///Returns shard for given thread
+	Shard &shard(unsigned int threadId) {return sh[threadId % shards];}
+
+	///Sums all shards into the snapshot
+	void snapshot(BackendStats &st) const {
+		auto ld = [](const std::atomic<std::size_t> &v) {return v.load(std::memory_order_relaxed);};
+		for (const Shard &s: sh) {
+			st.accepted += ld(s.accepted);
+			st.filtered += ld(s.filtered);
+			st.dropped += ld(s.dropped);
+			st.bytes += ld(s.bytes);
+			st.writes += ld(s.writes);
+			st.write_errors += ld(s.write_errors);
+			for (unsigned int i = 0; i < BackendStats::histogram_size; i++) {
+				st.latency[i] += ld(s.latency[i]);
+			}
+		}
+	}
+
+protected:
+	Shard sh[shards];
+};
+
+///Renders statistics as single line
+/**
+ * @code
+ * log::info("Logger: {}", backend.getStats());
+ * @endcode
+ */
+template<> class Stringify<BackendStats> {
+public:
+	template<typename Out>
+	void operator()(const BackendStats &st, const std::string_view &, Out &out) {
+		auto item = [&](const std::string_view &name, std::size_t val) {
+			for (char c: name) out(c);
+			StringifyUnsigned::writeNumber(val, 1, 10, [&](char c){out(c);});
+		};
+		item("accepted=", st.accepted);
+		item(" filtered=", st.filtered);
+		item(" dropped=", st.dropped);
+		item(" bytes=", st.bytes);
+		item(" writes=", st.writes);
+		item(" errors=", st.write_errors);
+		item(" queue=", st.queue_depth);
+		item(" threads=", st.threads);
+		item(" thread_mem=", st.thread_memory);
+		item(" p50<", st.latencyPercentile(0.5));
+		item("ns p99<", st.latencyPercentile(0.99));
+		item("ns p999<", st.latencyPercentile(0.999));
+		for (char c: std::string_view("ns")) out(c);
+	}
+};
+
+}
+
+
+
+#endif /* LOG4HPP_STATS_H_ */
@@ -8,24 +8,292 @@
 #ifndef STDERR_APPENDER_H_
 #define STDERR_APPENDER_H_
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <mutex>
-#include <iostream>
+#include <string_view>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
-namespace log4hpp {
+#include "config.h"
+#include "appender.h"
+#include "stats.h"
 
+namespace log4hpp {
 
+///Writes lines to the stderr (or other descriptor) through a coalescing buffer
+/**
+ * Lines are collected in the buffer and written by write(2)/writev(2). The buffer is flushed
+ * when it is full, when a message of the flush level (or more important) is written,
+ * or after the flush interval (by the background thread). Lines are always written complete, lines
+ * of different threads never interleave.
+ *
+ * Lines can be coloured by the level (ANSI sequences). Colours are enabled automatically, when
+ * the output is a terminal and the variable NO_COLOR is not set.
+ */
 class StdErrAppender {
 public:
-	void operator()(std::string_view line) {
-		std::lock_guard _(lock);
-		std::cerr << line;
+
+	enum class Color {
+		///never use colours
+		never,
+		///always use colours
+		always,
+		///use colours when the output is a terminal
+		automatic
+	};
+
+	///Constructor
+	/**
+	 * @param color colouring of lines
+	 * @param flushLevel messages with this level (or more important) are flushed immediately
+	 * @param flushInterval maximum time, how long a line can stay in the buffer (zero - no buffering)
+	 * @param bufferSize size of the buffer
+	 * @param fd output descriptor
+	 */
+	StdErrAppender(Color color = Color::automatic, Level::Type flushLevel = Level::warning,
+			std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100),
+			std::size_t bufferSize = 64*1024, int fd = STDERR_FILENO);
+	~StdErrAppender();
+	StdErrAppender(const StdErrAppender &) = delete;
+	StdErrAppender &operator=(const StdErrAppender &) = delete;
+
+	void operator()(const std::string_view &line);
+	void operator()(const std::string_view &line, const LineInfo &info);
+
+	///Writes content of the buffer
+	void flush();
+
+	///Writes line from the crash handler - async-signal-safe
+	/** Content of the buffer is written first (without locking) */
+	void crash_write(const std::string_view &line);
+	///Writes content of the buffer from the crash handler - async-signal-safe
+	void crash_flush();
+
+	///Adds counters of the appender to the statistics
+	void stats(BackendStats &st) const {
+		st.write_errors += write_errors.load(std::memory_order_relaxed);
+		st.dropped += dropped.load(std::memory_order_relaxed);
 	}
+
+	///Returns true, if lines are coloured
+	bool is_colored() const {return colored;}
+
 protected:
+	int fd;
+	bool colored;
+	Level::Type flushLevel;
+	std::chrono::milliseconds flushInterval;
+	std::size_t bufferSize;
+	std::unique_ptr<char[]> buffer;
+	std::size_t used = 0;
 	std::mutex lock;
+	std::condition_variable cond;
+	bool stopping = false;
+	std::thread flusher;
+	std::atomic<std::size_t> write_errors = {0};
+	std::atomic<std::size_t> dropped = {0};
 
+	void append_lk(const std::string_view &line, Level::Type level);
+	void flush_lk();
+	void run();
+	bool write_all(struct iovec *iov, int cnt);
 
+	static std::string_view colorOf(Level::Type level);
+	static bool detectColor(int fd);
+};
+
+///Writes lines to the stdout
+class StdOutAppender: public StdErrAppender {
+public:
+	StdOutAppender(Color color = Color::automatic, Level::Type flushLevel = Level::warning,
+			std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100),
+			std::size_t bufferSize = 64*1024)
+		:StdErrAppender(color, flushLevel, flushInterval, bufferSize, STDOUT_FILENO) {}
 };
 
+#ifdef LOG4HPP_WITH_IMPL
+
+LOG4HPP_IMPL StdErrAppender::StdErrAppender(Color color, Level::Type flushLevel,
+		std::chrono::milliseconds flushInterval, std::size_t bufferSize, int fd)
+:fd(fd)
+,colored(color == Color::always || (color == Color::automatic && detectColor(fd)))
+,flushLevel(flushLevel)
+,flushInterval(flushInterval)
+,bufferSize(flushInterval.count() > 0?bufferSize:0)
+,buffer(this->bufferSize?std::make_unique<char[]>(this->bufferSize):nullptr)
+{
+	if (this->bufferSize) flusher = std::thread([this]{run();});
+}
+
+LOG4HPP_IMPL StdErrAppender::~StdErrAppender() {
+	if (flusher.joinable()) {
+		{
+			std::lock_guard _(lock);
+			stopping = true;
+		}
+		cond.notify_one();
+		flusher.join();
+	}
+	std::lock_guard _(lock);
+	flush_lk();
+}
+
+LOG4HPP_IMPL void StdErrAppender::operator()(const std::string_view &line) {
+	std::lock_guard _(lock);
+	append_lk(line, Level::nolevel);
+}
+
+LOG4HPP_IMPL void StdErrAppender::operator()(const std::string_view &line, const LineInfo &info) {
+	std::lock_guard _(lock);
+	append_lk(line, info.level);
+	if (info.level != Level::nolevel && info.level <= flushLevel) flush_lk();
+}
+
+LOG4HPP_IMPL void StdErrAppender::flush() {
+	std::lock_guard _(lock);
+	flush_lk();
+}
+
+LOG4HPP_IMPL void StdErrAppender::append_lk(const std::string_view &line, Level::Type level) {
+	std::string_view body = line;
+	std::string_view color;
+	std::string_view reset;
+	if (colored && level != Level::nolevel) {
+		color = colorOf(level);
+		if (!color.empty()) {
+			reset = "\x1b[0m";
+			//reset must be before the end of line
+			while (!body.empty() && (body.back() == '\n' || body.back() == '\r')) body = body.substr(0, body.size()-1);
+		}
+	}
+	std::string_view parts[] = {color, body, reset, line.substr(body.size())};
+	std::size_t need = 0;
+	for (const auto &p: parts) need += p.size();
+	bool wasEmpty = used == 0;
+	if (used + need > bufferSize) {
+		//buffer and the line are written together
+		struct iovec iov[5];
+		int cnt = 0;
+		if (used) iov[cnt++] = {buffer.get(), used};
+		for (const auto &p: parts) {
+			if (!p.empty()) iov[cnt++] = {const_cast<char *>(p.data()), p.size()};
+		}
+		used = 0;
+		write_all(iov, cnt);
+		return;
+	}
+	for (const auto &p: parts) {
+		std::memcpy(buffer.get()+used, p.data(), p.size());
+		used += p.size();
+	}
+	if (wasEmpty) cond.notify_one();
+}
+
+LOG4HPP_IMPL void StdErrAppender::flush_lk() {
+	if (used == 0) return;
+	struct iovec iov = {buffer.get(), used};
+	used = 0;
+	write_all(&iov, 1);
+}
+
+LOG4HPP_IMPL bool StdErrAppender::write_all(struct iovec *iov, int cnt) {
+	while (cnt) {
+		auto r = ::writev(fd, iov, cnt);
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN) {
+				struct pollfd pfd = {fd, POLLOUT, 0};
+				if (::poll(&pfd, 1, 1000) > 0) continue;
+			}
+			++write_errors;
+			++dropped;
+			return false;
+		}
+		std::size_t w = static_cast<std::size_t>(r);
+		while (cnt && w >= iov->iov_len) {
+			w -= iov->iov_len;
+			++iov;
+			--cnt;
+		}
+		if (cnt) {
+			iov->iov_base = static_cast<char *>(iov->iov_base) + w;
+			iov->iov_len -= w;
+		}
+	}
+	return true;
+}
+
+LOG4HPP_IMPL void StdErrAppender::run() {
+	std::unique_lock lk(lock);
+	while (true) {
+		cond.wait(lk, [&]{return stopping || used > 0;});
+		if (stopping) break;
+		//lines written during the interval are collected
+		cond.wait_for(lk, flushInterval, [&]{return stopping;});
+		flush_lk();
+	}
+}
+
+LOG4HPP_IMPL void StdErrAppender::crash_write(const std::string_view &line) {
+	crash_flush();
+	std::size_t p = 0;
+	while (p < line.size()) {
+		auto s = ::write(fd, line.data()+p, line.size()-p);
+		if (s <= 0) break;
+		p+=s;
+	}
+}
+
+LOG4HPP_IMPL void StdErrAppender::crash_flush() {
+	std::size_t sz = used;
+	used = 0;
+	std::size_t p = 0;
+	while (p < sz && p < bufferSize) {
+		auto s = ::write(fd, buffer.get()+p, std::min(sz, bufferSize)-p);
+		if (s <= 0) break;
+		p+=s;
+	}
+}
+
+LOG4HPP_IMPL std::string_view StdErrAppender::colorOf(Level::Type level) {
+	switch ((level >> 12) & 0x7) {
+		case 1: return "\x1b[1;31m";	//fatal
+		case 2: return "\x1b[31m";		//error
+		case 3: return "\x1b[33m";		//warning
+		case 4: return "\x1b[36m";		//note
+		case 5: return "\x1b[32m";		//progress
+		case 7: return "\x1b[2m";		//debug
+		default: return std::string_view();
+	}
+}
+
+LOG4HPP_IMPL bool StdErrAppender::detectColor(int fd) {
+	if (!::isatty(fd)) return false;
+	if (std::getenv("NO_COLOR")) return false;
+	const char *term = std::getenv("TERM");
+	return !term || std::strcmp(term, "dumb") != 0;
+}
+
+
+#endif
+
+}
+
+#ifdef LOG4HPP_COMPILED
+#include "backend_impl.h"
+
+namespace log4hpp {
+LOG4HPP_EXTERN template class BackendT<StdErrAppender>;
+LOG4HPP_EXTERN template class BackendT<StdOutAppender>;
 }
+#endif
 
 #endif /* STDERR_APPENDER_H_ */
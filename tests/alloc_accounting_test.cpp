@@ -0,0 +1,134 @@
+/*
+ * alloc_accounting_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Log calls in the zero-allocation mode don't allocate - with contexts and with a snapshot
+ * of contexts. LOG4HPP_ALLOC_ACCOUNTING is defined for whole target by the CMakeLists.txt
+ */
+
+#define LOG4HPP_ALLOC_ACCOUNTING_IMPL
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "../logger.h"
+#include "../context_snapshot.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+///Keeps the last line in a fixed buffer (doesn't allocate)
+struct LastLineAppender {
+	char line[256];
+	std::size_t size = 0;
+	std::size_t count = 0;
+	void operator()(const std::string_view &ln) {
+		size = std::min(ln.size(), sizeof(line));
+		std::memcpy(line, ln.data(), size);
+		++count;
+	}
+	std::string_view last() const {return std::string_view(line, size);}
+};
+
+std::size_t reported = 0;
+
+///Runs the log calls in a new thread (buffers of the thread are preallocated by the first log call),
+///returns count of allocations per message
+template<typename Fn>
+double allocationsPerMessage(Fn &&fn, std::size_t count = 1000) {
+	double res = 0;
+	std::thread([&]{
+		fn(0);	//warm-up
+		std::size_t before = AllocAccounting::getThread().allocations;
+		for (std::size_t i = 0; i < count; i++) fn(i);
+		res = static_cast<double>(AllocAccounting::getThread().allocations - before) / count;
+	}).join();
+	return res;
+}
+
+void testCounting() {
+	Backend<LastLineAppender> bk("{m}{nl}", Level::debug);
+	bk.install();
+	bk.setActive();
+	AllocAccounting::reset();
+	AllocAccounting::setReporter([](std::size_t){++reported;});
+	//unbounded buffers grow inside of the log call
+	std::string big(100000, 'x');
+	std::thread([&]{
+		log::info("short");
+		log::info("{}", big);
+	}).join();
+	CHECK(AllocAccounting::get().allocations > 0);
+	CHECK(reported == AllocAccounting::get().allocations);
+	//allocations outside of log calls are not counted
+	std::size_t before = AllocAccounting::get().allocations;
+	std::string other(100000, 'y');
+	CHECK(AllocAccounting::get().allocations == before);
+	AllocAccounting::setReporter(nullptr);
+}
+
+void testZeroAllocation() {
+	Backend<LastLineAppender> bk("{m}{nl}", Level::info);
+	bk.install();
+	bk.setActive();
+	GlobalContext &gctx = GlobalContext::current();
+	gctx.setZeroAllocation(1024);
+	AllocAccounting::reset();
+
+	CHECK(allocationsPerMessage([](std::size_t i){
+		log::info("Enabled message {} {} {}", i, "text", std::string_view("a bit longer text argument"));
+	}) == 0);
+	CHECK(bk->last() == "Enabled message 999 text a bit longer text argument\n");
+
+	//longer than the bounded buffer
+	std::string big(5000, 'x');
+	CHECK(allocationsPerMessage([&](std::size_t i){log::info("{} {}", i, big);}) == 0);
+	CHECK(bk->last().substr(0, 4) == "999 ");
+
+	CHECK(allocationsPerMessage([](std::size_t i){
+		auto ctx = log::makeContext("request={}", i);
+		auto ctx2 = log::makeContext("user={}", "admin");
+		log::info("Enabled message {}", i);
+		ctx2.info("Context message {}", i);
+	}) == 0);
+	CHECK(bk->last() == "Context message 999\n");
+
+	CHECK(allocationsPerMessage([](std::size_t i){
+		auto ctx = log::makeContext("request={}", i);
+		ctx.setScopedLevel(Level::debug);
+		ctx.debug("Scoped level {}", i);
+	}) == 0);
+	CHECK(bk->last() == "Scoped level 999\n");
+
+	static const std::string user = "admin";
+	auto snap = []{
+		auto ctx = log::makeContext("request={}", 42);
+		auto ctx2 = log::makeContext("user={}", user);
+		return log::captureContext();
+	}();
+	CHECK(allocationsPerMessage([&](std::size_t i){
+		log::ContextSnapshot::Scope _(snap);
+		log::info("Snapshot message {}", i);
+		auto ctx = log::makeContext("step={}", i);
+		log::info("Nested message {}", i);
+	}) == 0);
+	CHECK(bk->last() == "Nested message 999\n");
+
+	CHECK(AllocAccounting::get().allocations == 0);
+	gctx.threadBufferSize = 0;
+	gctx.threadBufferBounded = false;
+}
+
+}
+
+int main() {
+	testCounting();
+	testZeroAllocation();
+	return result("alloc_accounting");
+}
@@ -0,0 +1,85 @@
+/*
+ * backend_write_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Accepted line - the time is computed only when it is needed, the write latency is sampled
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "../logger.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+struct TimeAppender {
+	std::vector<std::int64_t> times;
+	bool timeNeeded = false;
+	void operator()(const std::string_view &, const LineInfo &info) {times.push_back(info.time);}
+	bool needs_time() const {return timeNeeded;}
+};
+
+std::size_t measuredWrites(const BackendStats &st) {
+	std::size_t n = 0;
+	for (auto c: st.latency) n += c;
+	return n;
+}
+
+void testTime() {
+	{
+		Backend<TimeAppender> bk("{m}{nl}", Level::debug);
+		bk.setActive();
+		log::info("no time");
+		bk->timeNeeded = true;
+		log::info("time for the appender");
+		CHECK(bk->times.size() == 2);
+		if (bk->times.size() == 2) {
+			CHECK(bk->times[0] == 0);
+			CHECK(bk->times[1] != 0);
+		}
+	}
+	{
+		Backend<TimeAppender> bk("{t} {m}{nl}", Level::debug);
+		bk.setActive();
+		log::info("time in the format");
+		CHECK(bk->times.size() == 1 && bk->times[0] != 0);
+	}
+	{
+		Backend<TimeAppender> bk("{N} {m}{nl}", Level::debug);
+		bk.setNumbering(Numbering::hlc);
+		bk.setActive();
+		log::info("time for the numbering");
+		CHECK(bk->times.size() == 1 && bk->times[0] != 0);
+	}
+}
+
+void testLatencySampling() {
+	Backend<TimeAppender> bk("{m}{nl}", Level::debug);
+	bk.setActive();
+	for (int i = 0; i < 128; i++) log::info("line");
+	BackendStats st = bk.getStats();
+	CHECK(st.writes == 128);
+	CHECK(measuredWrites(st) == 2);
+	bk.setLatencySampling(1);
+	for (int i = 0; i < 10; i++) log::info("line");
+	CHECK(measuredWrites(bk.getStats()) == 12);
+	bk.setLatencySampling(0);
+	for (int i = 0; i < 10; i++) log::info("line");
+	st = bk.getStats();
+	CHECK(measuredWrites(st) == 12);
+	CHECK(st.writes == 148);
+}
+
+}
+
+int main() {
+	testTime();
+	testLatencySampling();
+	return result("backend_write");
+}
@@ -0,0 +1,187 @@
+/*
+ * bootstrap_backend_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Messages logged before Backend::install() - replay with contexts, threads switching to
+ * the installed backend, dropped messages, records reserved but not yet written
+ */
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../logger.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+struct CaptureAppender {
+	std::mutex lock;
+	std::vector<std::string> lines;
+	void operator()(const std::string_view &line) {
+		std::lock_guard _(lock);
+		lines.emplace_back(line);
+	}
+};
+
+///Exposes internals
+struct TestBootstrap: BootstrapBackend {
+	using BootstrapBackend::ReplayContext;
+	using BootstrapBackend::Result;
+	using BootstrapBackend::reserve;
+	using BootstrapBackend::fill;
+	using BootstrapBackend::recordSize;
+	using BootstrapBackend::capacity;
+};
+
+using Clock = std::chrono::steady_clock;
+
+///Threads log with contexts before install, the replayed lines must be the same as the lines
+///logged by the same threads after install
+void testStartupThreads() {
+	constexpr int threads = 4;
+	constexpr int messages = 50;
+	std::atomic<int> ready = {0};
+	std::atomic<bool> installed = {false};
+	int rebound[threads] = {};
+	std::vector<std::thread> thr;
+	for (int k = 0; k < threads; k++) {
+		thr.emplace_back([&, k]{
+			ThreadContext &tc = ThreadContext::current();
+			CHECK(tc.backend == BootstrapBackend::instance());
+			auto ctx = log::makeContext("thread={}", k);
+			auto ctx2 = log::makeContext("step");
+			for (int i = 0; i < messages; i++) log::info("message {}", i);
+			++ready;
+			while (!installed) std::this_thread::yield();
+			log::info("after install");
+			rebound[k] = tc.backend == std::atomic_load(&GlobalContext::current().backend)
+					&& tc.level == Level::debug;
+		});
+	}
+	while (ready != threads) std::this_thread::yield();
+	CHECK(BootstrapBackend::instance()->getStats().accepted == threads * messages);
+
+	Backend<CaptureAppender> bk("{T}|{c/}|{C/}|{m}{nl}", Level::debug);
+	bk.install();
+	installed = true;
+	for (auto &t: thr) t.join();
+	for (int k = 0; k < threads; k++) CHECK(rebound[k]);
+
+	//lines of each thread - the replayed messages followed by the live message
+	std::map<std::string, std::vector<std::string> > byPrefix;
+	for (const auto &l: bk->lines) {
+		auto p = l.rfind('|');
+		byPrefix[l.substr(0, p)].push_back(l.substr(p+1));
+	}
+	CHECK(bk->lines.size() == threads * (messages + 1));
+	CHECK(byPrefix.size() == threads);
+	for (const auto &[prefix, msgs]: byPrefix) {
+		//{T}|thread=k/step|step/thread=k
+		auto p1 = prefix.find('|');
+		auto p2 = prefix.find('|', p1+1);
+		std::string c = prefix.substr(p1+1, p2-p1-1);
+		std::string rc = prefix.substr(p2+1);
+		CHECK(c.compare(0, 7, "thread=") == 0 && c.compare(c.size()-5, 5, "/step") == 0);
+		CHECK(rc == "step/" + c.substr(0, c.size()-5));
+		CHECK(msgs.size() == messages + 1);
+		for (std::size_t i = 0; i < msgs.size(); i++) {
+			CHECK(msgs[i] == (i < messages?"message " + std::to_string(i) + "\n":std::string("after install\n")));
+		}
+	}
+	//a closed bootstrap backend is not replayed twice
+	BootstrapBackend::instance()->close(*std::atomic_load(&GlobalContext::current().backend));
+	CHECK(bk->lines.size() == threads * (messages + 1));
+}
+
+void testDropped() {
+	TestBootstrap bb;
+	BackendT<CaptureAppender> target("{m}{nl}", Level::debug);
+	ThreadContext &thr = ThreadContext::current();
+	bb.send(thr, Level::info, nullptr, "first");
+	//larger than the free space - dropped, but it doesn't block shorter messages
+	std::string big(bb.capacity, 'x');
+	bb.send(thr, Level::info, nullptr, big);
+	bb.send(thr, Level::info, nullptr, "second");
+	BackendStats st = bb.getStats();
+	CHECK(st.accepted == 2);
+	CHECK(st.dropped == 1);
+	//fill the rest
+	std::string line(100, 'y');
+	std::size_t sent = 0;
+	while (bb.getStats().dropped < 10) {
+		bb.send(thr, Level::info, nullptr, line);
+		++sent;
+	}
+	st = bb.getStats();
+	CHECK(st.accepted == sent - 9 + 2);
+
+	bb.close(target);
+	auto &lines = target->lines;
+	CHECK(lines.size() == st.accepted + 1);
+	if (lines.size() == st.accepted + 1) {
+		CHECK(lines[0] == "first\n");
+		CHECK(lines[1] == "second\n");
+		CHECK(lines[lines.size()-2] == line + "\n");
+		CHECK(lines.back() == "log4hpp: 10 messages logged before the backend was installed were dropped "
+				"(bootstrap buffer is full)\n");
+	}
+}
+
+void testCloseWaitsForReserved() {
+	TestBootstrap bb;
+	BackendT<CaptureAppender> target("{L} {m}{nl}", Level::debug);
+	ThreadContext &thr = ThreadContext::current();
+	//the writer reserved the record, but it was preempted before it wrote it
+	std::uint64_t ofs;
+	CHECK(bb.reserve(TestBootstrap::recordSize(0, 4), ofs) == TestBootstrap::Result::stored);
+	bb.send(thr, Level::info, nullptr, "next");
+	std::thread writer([&]{
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		bb.fill(ofs, LineInfo{Level::error, thr.threadId}, Timestamp::now(), std::string_view(), "late", false);
+	});
+	auto start = Clock::now();
+	bb.close(target);
+	CHECK(Clock::now() - start >= std::chrono::milliseconds(90));
+	writer.join();
+	CHECK(target->lines == std::vector<std::string>({"ERROR late\n", "INFO next\n"}));
+}
+
+void testReplayContext() {
+	auto render = [](const std::string_view &levels, bool reversed) {
+		TestBootstrap::ReplayContext ctx(levels);
+		Buffer out;
+		ctx.toStringChain(out, ", ", reversed);
+		return std::string(std::string_view(out));
+	};
+	CHECK(render("a\x1f" "bb\x1f" "ccc", false) == "a, bb, ccc");
+	CHECK(render("a\x1f" "bb\x1f" "ccc", true) == "ccc, bb, a");
+	CHECK(render("single", false) == "single");
+	CHECK(render("single", true) == "single");
+	//empty level is kept
+	CHECK(render("a\x1f\x1f" "c", false) == "a, , c");
+	TestBootstrap::ReplayContext ctx("x\x1fy");
+	Buffer out;
+	ctx.toString(out);
+	CHECK(std::string_view(out) == "x/y");
+}
+
+}
+
+int main() {
+	//must be first, the process-wide bootstrap backend is replayed once
+	testStartupThreads();
+	testDropped();
+	testCloseWaitsForReserved();
+	testReplayContext();
+	return result("bootstrap_backend");
+}
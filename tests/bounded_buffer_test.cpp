@@ -0,0 +1,142 @@
+/*
+ * bounded_buffer_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Zero-allocation mode - lines which don't fit to the bounded buffers keep the line terminator,
+ * contexts longer than the bounded buffers can be captured
+ */
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../logger.h"
+#include "../context_snapshot.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+struct CaptureAppender {
+	std::mutex lock;
+	std::vector<std::string> lines;
+	void operator()(const std::string_view &line) {
+		std::lock_guard _(lock);
+		lines.emplace_back(line);
+	}
+};
+
+void testBuffer() {
+	Buffer b;
+	b.reserve(16, true);
+	b.resize(100);
+	CHECK(b.size() == 16);
+	CHECK(b.overflow());
+	b.clear();
+	CHECK(!b.overflow());
+	b.append("0123456789");
+	CHECK(!b.overflow());
+	b.append("0123456789");
+	CHECK(b.overflow());
+	b.replaceTail("...\n");
+	CHECK(std::string_view(b) == "012345678901...\n");
+}
+
+void testTruncatedLine() {
+	constexpr std::size_t bufferSize = 64;
+	GlobalContext::current().setZeroAllocation(bufferSize);
+	{
+		Backend<CaptureAppender> bk("{t} {L} {m}{nl}", Level::debug);
+		bk.install();
+		//only new threads get the bounded buffers
+		std::thread thr([]{
+			log::error("short");
+			log::error("long {} end", std::string(1000, 'x'));
+		});
+		thr.join();
+		std::lock_guard _(bk->lock);
+		CHECK(bk->lines.size() == 2);
+		if (bk->lines.size() != 2) return;
+		CHECK(bk->lines[0].compare(bk->lines[0].size()-7, 7, " short\n") == 0);
+		//the message is truncated by the message buffer
+		const std::string &ln = bk->lines[1];
+		CHECK(ln.compare(ln.size()-15, 15, "...[truncated]\n") == 0);
+		CHECK(ln.find("long xxx") != ln.npos);
+	}
+	{
+		//the line is truncated by the line buffer
+		Backend<CaptureAppender> bk("{L} " + std::string(300, '-') + " {m}{lf}", Level::debug);
+		bk.install();
+		std::thread thr([]{
+			log::error("short");
+		});
+		thr.join();
+		std::lock_guard _(bk->lock);
+		CHECK(bk->lines.size() == 1);
+		if (bk->lines.empty()) return;
+		const std::string &ln = bk->lines[0];
+		CHECK(ln.size() == bufferSize*4);
+		CHECK(ln.compare(ln.size()-15, 15, "...[truncated]\n") == 0);
+	}
+	{
+		//time is formatted in the bounded buffer, it is not resized above its capacity
+		Backend<CaptureAppender> bk("{t[%Y-%m-%d %H:%M:%S]} {m}{nl}", Level::debug);
+		bk.install();
+		std::size_t cap = 0;
+		std::thread thr([&]{
+			log::error("msg");
+			cap = ThreadContext::current().fmt_buffer.capacity();
+		});
+		thr.join();
+		CHECK(cap == bufferSize);
+		std::lock_guard _(bk->lock);
+		CHECK(bk->lines.size() == 1);
+		if (bk->lines.empty()) return;
+		CHECK(bk->lines[0].size() == 19+5);
+		CHECK(bk->lines[0].compare(19, 5, " msg\n") == 0);
+	}
+}
+
+//creates nested contexts and captures the chain in the innermost one
+ContextSnapshot captureNested(unsigned int depth) {
+	if (depth == 0) return log::captureContext();
+	static const std::string pad(20, 'c');
+	auto ctx = log::makeContext("level-{}-{}", depth, pad);
+	return captureNested(depth-1);
+}
+
+void testSnapshotInBoundedMode() {
+	constexpr std::size_t bufferSize = 64;
+	GlobalContext::current().setZeroAllocation(bufferSize);
+	Backend<CaptureAppender> bk("{m}{nl}", Level::debug);
+	bk.install();
+	std::thread thr([]{
+		//the chain is much longer than the bounded temporary buffer
+		ContextSnapshot snap = captureNested(50);
+		CHECK(snap.levels() == 50);
+		if (snap.levels() != 50) return;
+		CHECK(snap.level(0) == "level-50-" + std::string(20, 'c'));
+		CHECK(snap.level(49) == "level-1-" + std::string(20, 'c'));
+		//single level longer than the buffer is truncated
+		std::string longText(1000, 'x');
+		auto ctx = log::makeContext("{}", longText);
+		ContextSnapshot snap2 = log::captureContext();
+		CHECK(snap2.levels() == 1);
+		if (snap2.levels() == 1) CHECK(snap2.level(0) == std::string(bufferSize, 'x'));
+	});
+	thr.join();
+}
+
+}
+
+int main() {
+	testBuffer();
+	testTruncatedLine();
+	testSnapshotInBoundedMode();
+	return result("bounded_buffer");
+}
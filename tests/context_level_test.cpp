@@ -0,0 +1,182 @@
+/*
+ * context_level_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Scoped level - carried by the snapshot to other threads, restored without losing changes of the level.
+ * Suspended scope moves the contexts created on it to the thread, which resumes it
+ */
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../logger.h"
+#include "../context_snapshot.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+struct CollectAppender {
+	std::vector<std::string> *lines;
+	std::mutex *mx;
+	void operator()(const std::string_view &line) {
+		std::lock_guard _(*mx);
+		lines->emplace_back(line);
+	}
+};
+
+std::vector<std::string> lines;
+std::mutex linesMx;
+
+bool logged(const std::string &line) {
+	std::lock_guard _(linesMx);
+	for (const auto &l: lines) if (l == line) return true;
+	return false;
+}
+
+void testSnapshotCarriesLevel(Backend<CollectAppender> &bk) {
+	ContextSnapshot snap;
+	{
+		auto ctx = log::makeContext("req");
+		ctx.setScopedLevel(Level::debug);
+		snap = log::captureContext();
+	}
+	std::thread thr([&]{
+		bk.setActive();
+		log::debug("thread before scope");
+		{
+			ContextSnapshot::Scope scope(snap);
+			log::debug("thread in scope");
+			//snapshot of the activated snapshot keeps the level
+			auto snap2 = log::captureContext();
+			CHECK(snap2 == snap);
+		}
+		log::debug("thread after scope");
+		//suspended scope, attached later (as by ContextAwaiter)
+		ContextSnapshot::Scope scope(snap, nullptr);
+		log::debug("thread suspended scope");
+		scope.resume();
+		log::debug("thread resumed scope");
+		scope.suspend();
+		log::debug("thread after suspend");
+	});
+	thr.join();
+	CHECK(!logged("thread before scope"));
+	CHECK(logged("thread in scope"));
+	CHECK(!logged("thread after scope"));
+	CHECK(!logged("thread suspended scope"));
+	CHECK(logged("thread resumed scope"));
+	CHECK(!logged("thread after suspend"));
+}
+
+void testNestedCapture() {
+	ContextSnapshot snap;
+	{
+		auto outer = log::makeContext("outer");
+		outer.setScopedLevel(Level::debug);
+		snap = log::captureContext();
+	}
+	ContextSnapshot snap2;
+	{
+		ContextSnapshot::Scope scope(snap);
+		auto inner = log::makeContext("inner");
+		snap2 = log::captureContext();
+	}
+	CHECK(snap2 != snap);
+	CHECK(snap2.levels() == 2);
+	std::thread thr([&]{
+		ContextSnapshot::Scope scope(snap2);
+		CHECK(ThreadContext::current().level == Level::debug);
+	});
+	thr.join();
+}
+
+//simulates coroutine frame, the inner context is created on the scope inside of the task
+struct Frame {
+	ContextSnapshot::Scope scope;
+	FmtContext<std::string_view> inner;
+	explicit Frame(const ContextSnapshot &snap):scope(snap),inner(&ThreadContext::current(), "inner") {}
+};
+
+void testSuspendedChain(Backend<CollectAppender> &bk) {
+	ContextSnapshot snap;
+	{
+		auto ctx = log::makeContext("req");
+		snap = log::captureContext();
+	}
+	std::unique_ptr<Frame> frame;
+	std::thread thrA([&]{
+		bk.setActive();
+		ThreadContext &thr = ThreadContext::current();
+		frame = std::make_unique<Frame>(snap);
+		frame->inner.setScopedLevel(Level::debug);
+		CHECK(thr.curCtx == &frame->inner);
+		CHECK(thr.level == Level::debug);
+		frame->scope.suspend();
+		//nothing of the task is left on the thread
+		CHECK(thr.curCtx == nullptr);
+		CHECK(thr.level == Level::info);
+	});
+	thrA.join();
+	std::thread thrB([&]{
+		bk.setActive();
+		ThreadContext &thr = ThreadContext::current();
+		auto outer = log::makeContext("outer");
+		frame->scope.resume();
+		CHECK(thr.curCtx == &frame->inner);
+		CHECK(frame->inner.getPrevContext() == &frame->scope);
+		CHECK(frame->scope.getPrevContext() == &outer);
+		CHECK(thr.level == Level::debug);
+		frame.reset();
+		CHECK(thr.curCtx == &outer);
+		CHECK(thr.level == Level::info);
+	});
+	thrB.join();
+}
+
+void testRestoreKeepsSetLevel(Backend<CollectAppender> &bk) {
+	ThreadContext &thr = ThreadContext::current();
+	{
+		auto ctx = log::makeContext("req");
+		ctx.setScopedLevel(Level::debug);
+		CHECK(thr.level == Level::debug);
+		ctx.setLevel(Level::warning);
+	}
+	//the level lowered inside of the context survives
+	CHECK(thr.level == Level::warning);
+	bk.setActive();
+	CHECK(thr.level == Level::info);
+	{
+		auto ctx = log::makeContext("req");
+		ctx.setScopedLevel(Level::debug);
+		//the backend activated inside of the context sets the level, it is kept
+		Backend<CollectAppender> bk2("{m}", Level::error, CollectAppender{&lines, &linesMx});
+		bk2.setActive();
+	}
+	CHECK(thr.level == Level::error);
+	bk.setActive();
+	{
+		auto ctx = log::makeContext("req");
+		ctx.setScopedLevel(Level::debug);
+	}
+	CHECK(thr.level == Level::info);
+}
+
+}
+
+int main() {
+	Backend<CollectAppender> bk("{m}", Level::info, CollectAppender{&lines, &linesMx});
+	bk.install();
+	testSnapshotCarriesLevel(bk);
+	testNestedCapture();
+	testSuspendedChain(bk);
+	testRestoreKeepsSetLevel(bk);
+	return result("context_level");
+}
@@ -0,0 +1,76 @@
+/*
+ * file_sync_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Durability of the file appender - sync on level, pipes are not synced
+ */
+
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../unix_file_appender.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+std::string tempPath(const char *name) {
+	return "/tmp/log4hpp-test-" + std::to_string(::getpid()) + "-" + name;
+}
+
+void testRegularFile() {
+	std::string path = tempPath("sync.log");
+	::unlink(path.c_str());
+	{
+		UnixFileAppender app(path, Durability::onLevel(Level::error));
+		app("info\n", LineInfo{Level::info});
+		app("error\n", LineInfo{Level::error});
+		BackendStats st = {};
+		app.stats(st);
+		CHECK(st.write_errors == 0);
+		CHECK(app.get_last_error() == 0);
+	}
+	struct stat st;
+	CHECK(::stat(path.c_str(), &st) == 0 && st.st_size == 11);
+	::unlink(path.c_str());
+}
+
+void testPipe() {
+	std::string path = tempPath("sync.fifo");
+	::unlink(path.c_str());
+	CHECK(::mkfifo(path.c_str(), 0600) == 0);
+	//reader must exist, otherwise open of the writer blocks
+	int rd = ::open(path.c_str(), O_RDONLY|O_NONBLOCK|O_CLOEXEC);
+	CHECK(rd >= 0);
+	{
+		Durability d = Durability::onLevel(Level::error, std::chrono::milliseconds(10));
+		UnixFileAppender app(path, d);
+		app("error\n", LineInfo{Level::error});
+		//let the background thread run its periodic sync
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		app("error\n", LineInfo{Level::error});
+		BackendStats st = {};
+		app.stats(st);
+		CHECK(st.write_errors == 0);
+		CHECK(app.get_last_error() == 0);
+		char buff[64];
+		CHECK(::read(rd, buff, sizeof(buff)) == 12);
+	}
+	::close(rd);
+	::unlink(path.c_str());
+}
+
+}
+
+int main() {
+	testRegularFile();
+	testPipe();
+	return result("file_sync");
+}
@@ -0,0 +1,119 @@
+/*
+ * format_limits_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Size limits of messages and arguments. The test is built in header-only and compiled mode,
+ * both must render the same text and report the real size of the message
+ */
+
+#include <cstdlib>
+#include <string>
+
+#include "../logger.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+template<typename ... Args>
+std::string render(std::size_t msgLimit, std::size_t argLimit, const std::string_view &msg, const Args & ... args) {
+	GlobalContext &gc = GlobalContext::current();
+	gc.maxMessageSize = msgLimit;
+	gc.maxArgumentSize = argLimit;
+	ThreadContext &thr = ThreadContext::current();
+	formatMessage(thr, msg, args...);
+	gc.maxMessageSize = 0;
+	gc.maxArgumentSize = 0;
+	return std::string(std::string_view(thr.buffer));
+}
+
+///Returns size reported by the truncation mark at the end of the text (-1 if there is no mark)
+std::size_t reportedSize(const std::string &txt) {
+	const std::string_view suffix(" bytes]");
+	if (txt.size() < suffix.size() || txt.compare(txt.size()-suffix.size(), suffix.size(), suffix)) return -1;
+	auto p = txt.rfind("...[truncated: ");
+	if (p == txt.npos) return -1;
+	return std::strtoul(txt.c_str()+p+15, nullptr, 10);
+}
+
+///Message limit only - the text is the prefix of the full text, the mark reports the full size
+template<typename ... Args>
+void checkMessageLimit(std::size_t msgLimit, const std::string_view &msg, const Args & ... args) {
+	std::string full = render(0, 0, msg, args...);
+	std::string limited = render(msgLimit, 0, msg, args...);
+	CHECK(full.size() > msgLimit);
+	CHECK(limited.compare(0, msgLimit, full, 0, msgLimit) == 0);
+	CHECK(reportedSize(limited) == full.size());
+	CHECK(limited.size() == msgLimit + std::string_view("...[truncated:  bytes]").size()
+			+ std::to_string(full.size()).size());
+}
+
+void testArgumentAndMessageLimit() {
+	std::string big(100, 'x');
+	const char *args = "a={} b={} c={}";
+	std::string full = render(0, 0, args, "0123456789abcdef", big, 1);
+	CHECK(full.size() == 125);
+	std::string limited = render(30, 10, args, "0123456789abcdef", big, 1);
+	//first argument is truncated by its limit, then the message limit is reached
+	CHECK(limited == "a=0123456789...[truncated: 16 ...[truncated: 125 bytes]");
+	CHECK(reportedSize(limited) == full.size());
+}
+
+void testArgumentLimit() {
+	std::string big(100, 'x');
+	std::string limited = render(0, 10, "a={} b={}", "0123456789abcdef", big);
+	CHECK(limited == "a=0123456789...[truncated: 16 bytes] b=xxxxxxxxxx...[truncated: 100 bytes]");
+	//argument which fits doesn't get a mark
+	CHECK(render(0, 10, "a={}", "0123456789") == "a=0123456789");
+}
+
+void testPadding() {
+	std::string big(100, 'x');
+	checkMessageLimit(30, "a={} b={:20>} c={}", "0123456789abcdef", big, 1);
+	checkMessageLimit(30, "a={} b={:20>} c={}", "0123456789abcdef", "short", 1);
+	checkMessageLimit(10, "a={:40<}|", "short");
+	CHECK(render(0, 0, "[{:8>}]", "abc") == "[     abc]");
+}
+
+///Escaped text - formatting stops at the limit, the rest is reported by its size in the source
+template<typename ... Args>
+void checkEscapedLimit(std::size_t msgLimit, const std::string_view &msg, const Args & ... args) {
+	std::string full = render(0, 0, msg, args...);
+	std::string limited = render(msgLimit, 0, msg, args...);
+	CHECK(full.size() > msgLimit);
+	CHECK(limited.compare(0, msgLimit, full, 0, msgLimit) == 0);
+	std::size_t reported = reportedSize(limited);
+	CHECK(reported > msgLimit && reported < full.size());
+}
+
+void testEscaped() {
+	std::string txt;
+	for (int i = 0; i < 50; i++) txt.append("a\n\"");
+	checkEscapedLimit(30, "v={:e}", txt);
+	checkEscapedLimit(30, "v={:j}", txt);
+	checkEscapedLimit(30, "v={:qd}", txt);
+	//the rest of the escaped text is not processed
+	std::string big(4*1024*1024, '\n');
+	std::string limited = render(30, 0, "v={:e}", big);
+	CHECK(reportedSize(limited) == 30 + big.size() - 14);
+}
+
+}
+
+int main() {
+	testArgumentAndMessageLimit();
+	testArgumentLimit();
+	testPadding();
+	testEscaped();
+	return result(
+#ifdef LOG4HPP_COMPILED
+			"format_limits (compiled)"
+#else
+			"format_limits"
+#endif
+			);
+}
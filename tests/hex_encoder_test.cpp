@@ -0,0 +1,175 @@
+/*
+ * hex_encoder_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * All implementations of the hex encoder (scalar, SSSE3, AVX2) must produce the same text,
+ * the hex dump ({:h}) must have the layout of `hexdump -C`
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../logger.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+///Exposes the implementations
+struct TestEncoder: HexEncoder {
+	using HexEncoder::Impl;
+	using HexEncoder::digits;
+	using HexEncoder::encodeScalar;
+	using HexEncoder::dumpRowScalar;
+#ifdef LOG4HPP_HAS_SIMD_HEX
+	using HexEncoder::encodeSSSE3;
+	using HexEncoder::encodeAVX2;
+	using HexEncoder::dumpRowSSSE3;
+#endif
+};
+
+struct Path {
+	const char *name;
+	TestEncoder::Impl impl;
+};
+
+std::vector<Path> availablePaths() {
+	std::vector<Path> out;
+#ifdef LOG4HPP_HAS_SIMD_HEX
+	if (__builtin_cpu_supports("ssse3")) out.push_back({"ssse3", TestEncoder::encodeSSSE3});
+	if (__builtin_cpu_supports("avx2")) out.push_back({"avx2", TestEncoder::encodeAVX2});
+#endif
+	return out;
+}
+
+///Data which contains each byte value, the offset shifts the values against the SIMD blocks
+std::vector<unsigned char> makeData(std::size_t n, std::size_t ofs) {
+	std::vector<unsigned char> data(n);
+	for (std::size_t i = 0; i < n; i++) data[i] = static_cast<unsigned char>(i * 7 + ofs);
+	return data;
+}
+
+std::string encodeWith(TestEncoder::Impl impl, const std::vector<unsigned char> &data, bool upper) {
+	//guard bytes after the output detect writes over the end
+	std::string out(data.size()*2 + 64, '#');
+	impl(data.data(), data.size(), out.data(), TestEncoder::digits(upper));
+	CHECK(out.compare(data.size()*2, 64, std::string(64, '#')) == 0);
+	out.resize(data.size()*2);
+	return out;
+}
+
+void testEncodePaths() {
+	auto paths = availablePaths();
+	std::printf("hex_encoder: %s, %zu SIMD paths tested\n", HexEncoder::implementation(), paths.size());
+	for (std::size_t n = 0; n <= 300; n++) {
+		for (std::size_t ofs: {0, 1, 13}) {
+			auto data = makeData(n, ofs);
+			for (bool upper: {false, true}) {
+				std::string expected = encodeWith(TestEncoder::encodeScalar, data, upper);
+				for (const Path &p: paths) {
+					std::string res = encodeWith(p.impl, data, upper);
+					if (res != expected) {
+						std::fprintf(stderr, "%s differs: n=%zu ofs=%zu upper=%d\n", p.name, n, ofs, upper);
+						CHECK(res == expected);
+					}
+				}
+				//the dispatching function
+				std::string res(n*2, '#');
+				HexEncoder::encode(data.data(), n, res.data(), upper);
+				CHECK(res == expected);
+			}
+		}
+	}
+	//each byte value
+	std::vector<unsigned char> all(256);
+	for (std::size_t i = 0; i < 256; i++) all[i] = static_cast<unsigned char>(i);
+	std::string expected = encodeWith(TestEncoder::encodeScalar, all, false);
+	for (std::size_t i = 0; i < 256; i++) {
+		char d[3];
+		std::snprintf(d, sizeof(d), "%02x", static_cast<unsigned int>(i));
+		CHECK(expected.compare(2*i, 2, d) == 0);
+	}
+	for (const Path &p: availablePaths()) CHECK(encodeWith(p.impl, all, false) == expected);
+}
+
+void testDumpRowPaths() {
+#ifdef LOG4HPP_HAS_SIMD_HEX
+	if (!__builtin_cpu_supports("ssse3")) return;
+	for (std::size_t ofs = 0; ofs < 256; ofs += 16) {
+		//16 rows cover each byte value
+		unsigned char data[16];
+		for (std::size_t i = 0; i < 16; i++) data[i] = static_cast<unsigned char>(ofs + i);
+		char a[HexEncoder::dumpRowSize];
+		char b[HexEncoder::dumpRowSize];
+		std::size_t na = TestEncoder::dumpRowScalar(data, 16, a);
+		std::size_t nb = TestEncoder::dumpRowSSSE3(data, b);
+		CHECK(na == HexEncoder::dumpRowSize);
+		CHECK(std::string_view(a, na) == std::string_view(b, nb));
+	}
+#endif
+}
+
+std::string renderDump(const std::string_view &data) {
+	ThreadContext &thr = ThreadContext::current();
+	formatMessage(thr, "{:h}", data);
+	return std::string(std::string_view(thr.buffer));
+}
+
+///Layout of `hexdump -v -C` (without the final line with the size), each row starts by a new line
+std::string referenceDump(const std::string_view &data) {
+	std::string out;
+	char tmp[32];
+	for (std::size_t ofs = 0; ofs < data.size(); ofs += 16) {
+		std::snprintf(tmp, sizeof(tmp), "\n%08zx ", ofs);
+		out.append(tmp);
+		std::size_t n = std::min<std::size_t>(16, data.size() - ofs);
+		for (std::size_t i = 0; i < 16; i++) {
+			if (i == 8) out.push_back(' ');
+			if (i < n) {
+				std::snprintf(tmp, sizeof(tmp), " %02x", static_cast<unsigned char>(data[ofs+i]));
+				out.append(tmp);
+			} else {
+				out.append("   ");
+			}
+		}
+		out.append("  |");
+		for (std::size_t i = 0; i < n; i++) {
+			unsigned char c = data[ofs+i];
+			out.push_back(c >= 0x20 && c < 0x7F?static_cast<char>(c):'.');
+		}
+		out.push_back('|');
+	}
+	return out;
+}
+
+void testDumpLayout() {
+	//output of `printf ABCDEFGHIJKLMNOPQRS | hexdump -C`
+	CHECK(renderDump("ABCDEFGHIJKLMNOPQRS") ==
+			"\n00000000  41 42 43 44 45 46 47 48  49 4a 4b 4c 4d 4e 4f 50  |ABCDEFGHIJKLMNOP|"
+			"\n00000010  51 52 53                                          |QRS|");
+	CHECK(renderDump(std::string_view("\x00\x7f\x80\xff\x1f x", 7)) ==
+			"\n00000000  00 7f 80 ff 1f 20 78                              |..... x|");
+	std::string all;
+	for (int i = 0; i < 256; i++) all.push_back(static_cast<char>(i));
+	for (std::size_t n: {0, 1, 7, 8, 9, 15, 16, 17, 31, 33, 255, 256}) {
+		std::string_view part(all.data(), n);
+		CHECK(renderDump(part) == referenceDump(part));
+	}
+	//more than one block of rows rendered at once
+	std::string big = all + all + all + all + all;
+	CHECK(renderDump(big) == referenceDump(big));
+}
+
+}
+
+int main() {
+	testEncodePaths();
+	testDumpRowPaths();
+	testDumpLayout();
+	return result("hex_encoder");
+}
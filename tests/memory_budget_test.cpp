@@ -0,0 +1,50 @@
+/*
+ * memory_budget_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Memory budget of thread buffers - applied also when it is set after the buffers have grown
+ */
+
+#include <string>
+
+#include "../logger.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+struct NullAppender {
+	void operator()(const std::string_view &) {}
+};
+
+std::size_t threadBuffers() {
+	ThreadContext &thr = ThreadContext::current();
+	return thr.buffer.capacity() + thr.bk_buffer.capacity() + thr.fmt_buffer.capacity();
+}
+
+void testBudgetAtRuntime() {
+	GlobalContext &gc = GlobalContext::current();
+	Backend<NullAppender> bk("{m}{nl}", Level::debug);
+	bk.install();
+	log::error("{}", std::string(1024*1024, 'x'));
+	std::size_t grown = threadBuffers();
+	CHECK(grown > 2*1024*1024);
+	CHECK(gc.threadMemory >= grown);
+	//budget is set later, the buffers are released after the next message
+	gc.threadMemoryBudget = 64*1024;
+	log::error("short");
+	CHECK(threadBuffers() <= 64*1024);
+	CHECK(gc.threadMemory < grown);
+	gc.threadMemoryBudget = 0;
+}
+
+}
+
+int main() {
+	testBudgetAtRuntime();
+	return result("memory_budget");
+}
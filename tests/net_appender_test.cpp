@@ -0,0 +1,183 @@
+/*
+ * net_appender_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Drives NetAppender against a loopback server - framing, reconnect, drop counting
+ */
+
+#include <cstdint>
+#include <string>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../net_appender.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+class TestAppender: public NetAppender {
+public:
+	using NetAppender::NetAppender;
+	using NetAppender::stop;
+};
+
+///Opens loopback socket on a free port
+int listenLoopback(int type, std::string &port) {
+	int s = ::socket(AF_INET, type|SOCK_CLOEXEC, 0);
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t len = sizeof(addr);
+	if (::bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))
+			|| ::getsockname(s, reinterpret_cast<sockaddr *>(&addr), &len)) {
+		::close(s);
+		return -1;
+	}
+	if (type == SOCK_STREAM) ::listen(s, 4);
+	port = std::to_string(ntohs(addr.sin_port));
+	return s;
+}
+
+void testNewlineFraming() {
+	std::string port;
+	int s = listenLoopback(SOCK_STREAM, port);
+	CHECK(s >= 0);
+	{
+		NetAppender app("127.0.0.1", port, NetAppender::Protocol::tcp, NetAppender::Framing::newline);
+		int c = acceptTimeout(s);
+		CHECK(c >= 0);
+		app("alpha\n");
+		app("beta");
+		app("gamma\r\n");
+		std::string buff;
+		CHECK(readUntil(c, buff, "gamma\n"));
+		CHECK(buff == "alpha\nbeta\ngamma\n");
+		CHECK(waitFor([&]{return app.getSent() == 3;}));
+		CHECK(app.getSentBytes() == buff.size());
+		CHECK(app.getConnects() == 1);
+		::close(c);
+	}
+	::close(s);
+}
+
+void testLengthFraming() {
+	std::string port;
+	int s = listenLoopback(SOCK_STREAM, port);
+	CHECK(s >= 0);
+	{
+		NetAppender app("127.0.0.1", port, NetAppender::Protocol::tcp, NetAppender::Framing::length);
+		int c = acceptTimeout(s);
+		CHECK(c >= 0);
+		std::string big(70000, 'b');
+		app("hello\n");
+		app(big);
+		std::string buff;
+		CHECK(readBytes(c, buff, 4+5+4+big.size()));
+		CHECK(buff.size() == 4+5+4+big.size());
+		auto len = [&](std::size_t pos) {
+			auto b = reinterpret_cast<const unsigned char *>(buff.data()+pos);
+			return (std::uint32_t(b[0]) << 24) | (std::uint32_t(b[1]) << 16) | (std::uint32_t(b[2]) << 8) | b[3];
+		};
+		CHECK(len(0) == 5);
+		CHECK(buff.compare(4, 5, "hello") == 0);
+		CHECK(len(9) == big.size());
+		CHECK(buff.compare(13, big.size(), big) == 0);
+		::close(c);
+	}
+	::close(s);
+}
+
+void testUdp() {
+	std::string port;
+	int s = listenLoopback(SOCK_DGRAM, port);
+	CHECK(s >= 0);
+	{
+		NetAppender app("127.0.0.1", port, NetAppender::Protocol::udp);
+		app("one\n");
+		app("two");
+		std::string d[2];
+		for (auto &x: d) {
+			pollfd pfd = {s, POLLIN, 0};
+			CHECK(::poll(&pfd, 1, 5000) == 1);
+			char tmp[256];
+			auto r = ::recv(s, tmp, sizeof(tmp), MSG_DONTWAIT);
+			if (r > 0) x.assign(tmp, r);
+		}
+		CHECK(d[0] == "one");
+		CHECK(d[1] == "two");
+	}
+	::close(s);
+}
+
+void testReconnect() {
+	std::string port;
+	int s = listenLoopback(SOCK_STREAM, port);
+	CHECK(s >= 0);
+	{
+		TestAppender app("127.0.0.1", port);
+		int c = acceptTimeout(s);
+		CHECK(c >= 0);
+		app("first");
+		std::string buff;
+		CHECK(readUntil(c, buff, "first\n"));
+		::close(c);
+		//lines written before the reset is noticed are lost in the closed connection,
+		//keep logging until the appender reconnects
+		c = -1;
+		for (int i = 0; i < 200 && c < 0; i++) {
+			app("filler");
+			c = acceptTimeout(s, 50);
+		}
+		CHECK(c >= 0);
+		CHECK(waitFor([&]{return app.getConnects() == 2;}));
+		app("after");
+		buff.clear();
+		CHECK(readUntil(c, buff, "after\n"));
+		BackendStats st = {};
+		app.stats(st);
+		CHECK(st.write_errors >= 1);
+		app.stop();
+		::close(c);
+	}
+	::close(s);
+}
+
+void testDropCount() {
+	//free port without a listener - connection is refused
+	std::string port;
+	int s = listenLoopback(SOCK_STREAM, port);
+	::close(s);
+	constexpr std::size_t count = 200;
+	TestAppender app("127.0.0.1", port, NetAppender::Protocol::tcp, NetAppender::Framing::newline, 4096);
+	std::string line(100, 'x');
+	for (std::size_t i = 0; i < count; i++) app(line);
+	BackendStats st = {};
+	app.stats(st);
+	CHECK(st.dropped > 0);
+	CHECK(st.dropped + st.queue_depth == count);
+	CHECK(app.getSent() == 0);
+	app.stop();
+	st = {};
+	app.stats(st);
+	CHECK(st.dropped == count);
+	CHECK(st.write_errors >= 1);
+}
+
+}
+
+int main() {
+	testNewlineFraming();
+	testLengthFraming();
+	testUdp();
+	testReconnect();
+	testDropCount();
+	return result("net_appender");
+}
@@ -0,0 +1,90 @@
+/*
+ * segment_appender_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Segment appender - count of segments (open files) and sync threads doesn't grow with threads
+ */
+
+#include <string>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../unix_segment_appender.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+std::string tempPath(const char *name) {
+	return "/tmp/log4hpp-test-" + std::to_string(::getpid()) + "-" + name;
+}
+
+///Returns count of entries in the directory
+std::size_t countEntries(const char *path) {
+	std::size_t n = 0;
+	DIR *d = ::opendir(path);
+	if (!d) return 0;
+	while (::readdir(d)) ++n;
+	::closedir(d);
+	return n;
+}
+
+void testBoundedSegments() {
+	constexpr unsigned int groups = 4;
+	std::string path = tempPath("seg.log");
+	std::size_t fds = countEntries("/proc/self/fd");
+	std::size_t threads = countEntries("/proc/self/task");
+	{
+		UnixSegmentAppender app(path, groups, 7, 24*60*60, "%Y%m%d",
+				Durability::periodic(std::chrono::milliseconds(10)));
+		//thread ids are never reused, each new thread gets a new id
+		for (ThreadId id = 1; id <= 1000; id++) {
+			app("line\n", LineInfo{Level::info, id});
+		}
+		//one descriptor per segment (+ duplicates held by the sync thread)
+		CHECK(countEntries("/proc/self/fd") <= fds + 2*groups);
+		//single sync thread for all segments
+		CHECK(countEntries("/proc/self/task") == threads + 1);
+		BackendStats st = {};
+		app.stats(st);
+		CHECK(st.write_errors == 0);
+		for (unsigned int i = 0; i < groups; i++) {
+			struct stat s;
+			CHECK(::stat(app.getSegmentPath(i).c_str(), &s) == 0 && s.st_size == 250*5);
+		}
+		CHECK(::access(app.getSegmentPath(groups).c_str(), F_OK) != 0);
+		for (unsigned int i = 0; i < groups; i++) ::unlink(app.getSegmentPath(i).c_str());
+	}
+	CHECK(countEntries("/proc/self/fd") == fds);
+	CHECK(countEntries("/proc/self/task") == threads);
+}
+
+void testDefaultGroups() {
+	std::string path = tempPath("seg-default.log");
+	unsigned int cpus = std::max(1U, std::thread::hardware_concurrency());
+	UnixSegmentAppender app(path);
+	for (ThreadId id = 1; id <= 2*cpus + 10; id++) {
+		app("line\n", LineInfo{Level::info, id});
+	}
+	unsigned int files = 0;
+	for (unsigned int i = 0; i < 2*cpus + 10; i++) {
+		if (::access(app.getSegmentPath(i).c_str(), F_OK) == 0) {
+			++files;
+			::unlink(app.getSegmentPath(i).c_str());
+		}
+	}
+	CHECK(files == cpus);
+}
+
+}
+
+int main() {
+	testBoundedSegments();
+	testDefaultGroups();
+	return result("segment_appender");
+}
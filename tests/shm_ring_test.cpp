@@ -0,0 +1,259 @@
+/*
+ * shm_ring_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Crash handling of the shared memory ring - the producer is killed in the middle of a record,
+ * the consumer is restarted. When the path of log4hpp-collector is passed as the argument, the
+ * same is tested with the collector
+ *
+ * usage: log4hpp-test-shm-ring [collector]
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../shm_ring.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+class TestRing: public ShmRing {
+public:
+	using ShmRing::ShmRing;
+
+	///Reserves space for the record as push() does, but doesn't commit it - the state left by
+	///a producer killed in the middle of the record
+	/**
+	 * @param len length of the record
+	 * @param writeHeader true - killed after the header with the length was written, false -
+	 * killed right after the reservation
+	 */
+	void reserveOnly(std::size_t len, bool writeHeader) {
+		std::size_t need = align8(sizeof(std::uint32_t) + len);
+		//test records never wrap around the end of the ring
+		std::uint64_t h = hdr->head.fetch_add(need, std::memory_order_acq_rel);
+		if (writeHeader) {
+			recordHdr(h).store(static_cast<std::uint32_t>(len << lengthShift) | flagReserved, std::memory_order_release);
+		}
+	}
+};
+
+std::string ringName(const char *name) {
+	std::string n = "/log4hpp-test-" + std::to_string(::getpid()) + "-" + name;
+	ShmRing::unlink(n);
+	return n;
+}
+
+std::vector<std::string> drainAll(ShmRing &ring, std::size_t limit = static_cast<std::size_t>(-1)) {
+	std::vector<std::string> out;
+	ring.drain([&](const std::string_view &rec){out.emplace_back(rec);}, limit);
+	return out;
+}
+
+///Runs the function in a child process, which keeps running until it is killed
+/**
+ * The function opens the ring on the heap, the ring must stay open until the child is killed
+ *
+ * @return pid of the child, after the function finished
+ */
+template<typename Fn>
+pid_t startChild(Fn &&fn) {
+	int p[2];
+	if (::pipe(p)) return -1;
+	pid_t pid = ::fork();
+	if (pid == 0) {
+		::close(p[0]);
+		char c = 0;
+		try {
+			fn();
+			c = 1;
+		} catch (...) {}
+		if (::write(p[1], &c, 1) != 1) ::_exit(1);
+		while (true) ::pause();
+	}
+	::close(p[1]);
+	pollfd pfd = {p[0], POLLIN, 0};
+	char c = 0;
+	bool ok = ::poll(&pfd, 1, 5000) == 1 && ::read(p[0], &c, 1) == 1 && c == 1;
+	::close(p[0]);
+	CHECK(ok);
+	return pid;
+}
+
+void killChild(pid_t pid, int sig = SIGKILL) {
+	::kill(pid, sig);
+	//the zombie would be still alive for the ring
+	int st;
+	::waitpid(pid, &st, 0);
+}
+
+std::vector<std::string> records(const char *prefix, int from, int to) {
+	std::vector<std::string> out;
+	for (int i = from; i < to; i++) out.push_back(prefix + std::to_string(i));
+	return out;
+}
+
+void testProducerKilledAfterHeader() {
+	std::string name = ringName("header");
+	TestRing consumer(name, ShmRing::Role::consumer, 65536);
+	pid_t pid = startChild([&]{
+		TestRing &ring = *new TestRing(name, ShmRing::Role::producer);
+		ring.push("before 1");
+		ring.push("before 2");
+		ring.reserveOnly(20, true);
+		ring.push("after 1");
+		ring.push("after 2");
+	});
+	//the producer is alive, the consumer waits for the record
+	CHECK(drainAll(consumer) == std::vector<std::string>({"before 1", "before 2"}));
+	CHECK(drainAll(consumer).empty());
+	CHECK(consumer.getLost() == 0);
+	killChild(pid);
+	//the length is known - only the incomplete record is lost
+	CHECK(drainAll(consumer) == std::vector<std::string>({"after 1", "after 2"}));
+	CHECK(consumer.getLost() == 1);
+	CHECK(consumer.getConsumed() == 4);
+	CHECK(consumer.getPending() == 0);
+	//new producer continues
+	{
+		TestRing producer(name, ShmRing::Role::producer);
+		CHECK(producer.push("restarted"));
+	}
+	CHECK(drainAll(consumer) == std::vector<std::string>({"restarted"}));
+	CHECK(consumer.getLost() == 1);
+	ShmRing::unlink(name);
+}
+
+void testProducerKilledBeforeHeader() {
+	std::string name = ringName("reserved");
+	TestRing consumer(name, ShmRing::Role::consumer, 65536);
+	pid_t pid = startChild([&]{
+		TestRing &ring = *new TestRing(name, ShmRing::Role::producer);
+		ring.push("before");
+		ring.reserveOnly(20, false);
+		ring.push("after");
+	});
+	CHECK(drainAll(consumer) == std::vector<std::string>({"before"}));
+	killChild(pid);
+	//records behind the reservation can't be located, the rest of the ring is skipped
+	CHECK(drainAll(consumer).empty());
+	CHECK(consumer.getLost() == 1);
+	CHECK(consumer.getPending() == 0);
+	{
+		TestRing producer(name, ShmRing::Role::producer);
+		CHECK(producer.push("restarted"));
+	}
+	CHECK(drainAll(consumer) == std::vector<std::string>({"restarted"}));
+	ShmRing::unlink(name);
+}
+
+void testConsumerRestart() {
+	std::string name = ringName("consumer");
+	TestRing producer(name, ShmRing::Role::producer, 65536);
+	for (int i = 0; i < 10; i++) producer.push("rec " + std::to_string(i));
+	//the consumer is killed after it consumed some records
+	pid_t pid = startChild([&]{
+		TestRing &ring = *new TestRing(name, ShmRing::Role::consumer);
+		if (ring.drain([](const std::string_view &){}, 4) != 4) throw std::runtime_error("drain");
+	});
+	{
+		//the role is taken by a living process
+		pid_t other = ::fork();
+		if (other == 0) {
+			try {
+				TestRing ring(name, ShmRing::Role::consumer);
+			} catch (const std::system_error &e) {
+				::_exit(e.code().value() == EBUSY?0:1);
+			}
+			::_exit(1);
+		}
+		int st = -1;
+		::waitpid(other, &st, 0);
+		CHECK(WIFEXITED(st) && WEXITSTATUS(st) == 0);
+	}
+	killChild(pid);
+	TestRing consumer(name, ShmRing::Role::consumer);
+	CHECK(drainAll(consumer) == records("rec ", 4, 10));
+	CHECK(consumer.getConsumed() == 10);
+	CHECK(consumer.getLost() == 0);
+	CHECK(consumer.getDropped() == 0);
+	ShmRing::unlink(name);
+}
+
+std::string readFile(const std::string &path) {
+	std::ifstream f(path);
+	std::stringstream s;
+	s << f.rdbuf();
+	return s.str();
+}
+
+pid_t startCollector(const char *collector, const std::string &name, const std::string &log) {
+	pid_t pid = ::fork();
+	if (pid == 0) {
+		::execl(collector, collector, name.c_str(), log.c_str(), static_cast<char *>(nullptr));
+		::_exit(127);
+	}
+	return pid;
+}
+
+bool stopCollector(pid_t pid) {
+	::kill(pid, SIGTERM);
+	int st = -1;
+	::waitpid(pid, &st, 0);
+	return WIFEXITED(st) && WEXITSTATUS(st) == 0;
+}
+
+void testCollector(const char *collector) {
+	std::string name = ringName("collector");
+	std::string log = "/tmp/log4hpp-test-" + std::to_string(::getpid()) + "-collector.log";
+	::unlink(log.c_str());
+	pid_t col = startCollector(collector, name, log);
+	CHECK(waitFor([&]{
+		TestRing ring(name, ShmRing::Role::producer);
+		return ring.isAlive(ShmRing::Role::consumer);
+	}));
+	pid_t pid = startChild([&]{
+		TestRing &ring = *new TestRing(name, ShmRing::Role::producer);
+		ring.push("before\n");
+		ring.reserveOnly(20, true);
+		ring.push("after\n");
+	});
+	std::string lostLine = "log4hpp-collector: 0 records dropped (ring full), 1 incomplete records lost\n";
+	CHECK(waitFor([&]{return readFile(log) == "before\n";}));
+	killChild(pid);
+	CHECK(waitFor([&]{return readFile(log) == "before\nafter\n" + lostLine;}));
+	//records pushed while the collector is down are written by the next collector
+	CHECK(stopCollector(col));
+	{
+		TestRing producer(name, ShmRing::Role::producer);
+		CHECK(producer.push("while down\n"));
+	}
+	col = startCollector(collector, name, log);
+	CHECK(waitFor([&]{return readFile(log) == "before\nafter\n" + lostLine + "while down\n";}));
+	CHECK(stopCollector(col));
+	ShmRing::unlink(name);
+	::unlink(log.c_str());
+}
+
+}
+
+int main(int argc, char **argv) {
+	testProducerKilledAfterHeader();
+	testProducerKilledBeforeHeader();
+	testConsumerRestart();
+	if (argc > 1) testCollector(argv[1]);
+	return result("shm_ring");
+}
@@ -0,0 +1,83 @@
+/*
+ * test_utils.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_TESTS_TEST_UTILS_H_
+#define LOG4HPP_TESTS_TEST_UTILS_H_
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace log4hpp_test {
+
+inline int &failures() {
+	static int f = 0;
+	return f;
+}
+
+#define CHECK(expr) do { \
+	if (!(expr)) { \
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+		++log4hpp_test::failures(); \
+	} \
+} while(false)
+
+///Waits until the predicate is true
+template<typename Fn>
+inline bool waitFor(Fn &&fn, std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+	auto until = std::chrono::steady_clock::now() + timeout;
+	while (!fn()) {
+		if (std::chrono::steady_clock::now() > until) return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	return true;
+}
+
+///Accepts a connection with timeout
+inline int acceptTimeout(int listenFd, int timeoutMs = 5000) {
+	pollfd pfd = {listenFd, POLLIN, 0};
+	if (::poll(&pfd, 1, timeoutMs) != 1) return -1;
+	return ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+}
+
+///Reads from the stream until the buffer contains the given count of bytes
+inline bool readBytes(int s, std::string &buff, std::size_t count, int timeoutMs = 5000) {
+	while (buff.size() < count) {
+		pollfd pfd = {s, POLLIN, 0};
+		if (::poll(&pfd, 1, timeoutMs) != 1) return false;
+		char tmp[4096];
+		auto r = ::recv(s, tmp, sizeof(tmp), 0);
+		if (r <= 0) return false;
+		buff.append(tmp, r);
+	}
+	return true;
+}
+
+///Reads from the stream until the buffer contains the given text
+inline bool readUntil(int s, std::string &buff, const std::string &text, int timeoutMs = 5000) {
+	while (buff.find(text) == buff.npos) {
+		if (!readBytes(s, buff, buff.size()+1, timeoutMs)) return false;
+	}
+	return true;
+}
+
+inline int result(const char *name) {
+	if (failures()) {
+		std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+		return 1;
+	}
+	std::fprintf(stderr, "%s: passed\n", name);
+	return 0;
+}
+
+}
+
+#endif /* LOG4HPP_TESTS_TEST_UTILS_H_ */
@@ -0,0 +1,73 @@
+/*
+ * timestamp_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Conversion of the call-site timestamp to the wall-clock time
+ */
+
+#include <cstdint>
+#include <dirent.h>
+
+#include "../timestamp.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+///error of the calibration - the anchor is sampled with error of few microseconds, the frequency
+///is measured against CLOCK_MONOTONIC_RAW, while CLOCK_REALTIME can be slewed by NTP up to 500ppm
+///during the refresh period (a second)
+constexpr std::int64_t calibrationError = 1000000;
+
+std::size_t countThreads() {
+	std::size_t n = 0;
+	DIR *d = ::opendir("/proc/self/task");
+	if (!d) return 0;
+	while (::readdir(d)) ++n;
+	::closedir(d);
+	return n;
+}
+
+///Converts the tick captured between two readings of the realtime clock, returns distance of the
+///result from the measured interval [a,b] (zero, when the result is inside)
+std::int64_t conversionError() {
+	std::int64_t a = Timestamp::realtime();
+	Timestamp::Tick tick = Timestamp::now();
+	std::int64_t b = Timestamp::realtime();
+	std::int64_t t = Timestamp::toRealtime(tick);
+	if (t < a) return a - t;
+	if (t > b) return t - b;
+	return 0;
+}
+
+void testConversion() {
+	std::size_t threads = countThreads();
+	Timestamp::calibrate();
+	//calibration doesn't start any thread
+	CHECK(countThreads() == threads);
+	for (int i = 0; i < 1000; i++) {
+		std::int64_t err = conversionError();
+		if (err >= calibrationError) {
+			CHECK(err < calibrationError);
+			break;
+		}
+	}
+}
+
+void testRefresh() {
+	//a tick far in the future (more than a second) forces refresh of the anchor by the converting thread
+	Timestamp::toRealtime(Timestamp::now() + 4000000000ULL);
+	CHECK(conversionError() < calibrationError);
+}
+
+}
+
+int main() {
+	testConversion();
+	testRefresh();
+	return result("timestamp");
+}
@@ -0,0 +1,291 @@
+/*
+ * unix_pipe_appender_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Drives UnixPipeAppender against a temporary fifo - late open, overflow policies, the in-band
+ * notice about dropped lines, a line interrupted by the reader
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../unix_pipe_appender.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string makeFifo(const char *name) {
+	std::string path = "/tmp/log4hpp-test-" + std::to_string(::getpid()) + "-" + name + ".fifo";
+	::unlink(path.c_str());
+	CHECK(::mkfifo(path.c_str(), 0600) == 0);
+	return path;
+}
+
+int openReader(const std::string &path) {
+	return ::open(path.c_str(), O_RDONLY|O_NONBLOCK|O_CLOEXEC);
+}
+
+///Reads from the fifo until the buffer contains the text (the appender opens the fifo later
+///than the reader, read returns 0 until then)
+bool readPipeUntil(int f, std::string &buff, const std::string &text, int timeoutMs = 5000) {
+	auto until = Clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (buff.find(text) == buff.npos) {
+		if (Clock::now() > until) return false;
+		pollfd pfd = {f, POLLIN, 0};
+		::poll(&pfd, 1, 10);
+		char tmp[65536];
+		auto r = ::read(f, tmp, sizeof(tmp));
+		if (r > 0) buff.append(tmp, r);
+		else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+///Reads exactly count bytes
+bool readPipeBytes(int f, std::string &buff, std::size_t count, int timeoutMs = 5000) {
+	auto until = Clock::now() + std::chrono::milliseconds(timeoutMs);
+	while (buff.size() < count) {
+		if (Clock::now() > until) return false;
+		pollfd pfd = {f, POLLIN, 0};
+		::poll(&pfd, 1, 10);
+		char tmp[65536];
+		auto r = ::read(f, tmp, std::min(sizeof(tmp), count - buff.size()));
+		if (r > 0) buff.append(tmp, r);
+		else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+std::vector<std::string> splitLines(const std::string &buff) {
+	std::vector<std::string> out;
+	std::size_t p = 0;
+	while (p < buff.size()) {
+		std::size_t e = buff.find('\n', p);
+		if (e == buff.npos) e = buff.size();
+		out.push_back(buff.substr(p, e-p));
+		p = e+1;
+	}
+	return out;
+}
+
+///numbered line, about 100 bytes
+std::string testLine(const char *prefix, std::size_t n) {
+	char tmp[32];
+	std::snprintf(tmp, sizeof(tmp), "%s %03zu ", prefix, n);
+	return tmp + std::string(90, 'x') + "\n";
+}
+
+///parses the count from the notice (-1 when the line is not the notice)
+long noticeCount(const std::string &line) {
+	long n = -1;
+	int end = 0;
+	if (std::sscanf(line.c_str(), "*** log4hpp: %ld lines dropped ***%n", &n, &end) != 1
+			|| static_cast<std::size_t>(end) != line.size()) return -1;
+	return n;
+}
+
+BackendStats getStats(const UnixPipeAppender &app) {
+	BackendStats st = {};
+	app.stats(st);
+	return st;
+}
+
+///Connects a reader after the lines were queued, pushes the end mark once the queue is drained.
+///Returns received lines without the end mark
+std::vector<std::string> connectAndRead(UnixPipeAppender &app, const std::string &path) {
+	int f = openReader(path);
+	CHECK(f >= 0);
+	CHECK(waitFor([&]{return app.isConnected() && getStats(app).queue_depth == 0;}));
+	app("end\n");
+	std::string buff;
+	CHECK(readPipeUntil(f, buff, "end\n"));
+	::close(f);
+	auto lines = splitLines(buff);
+	CHECK(!lines.empty() && lines.back() == "end");
+	if (!lines.empty()) lines.pop_back();
+	return lines;
+}
+
+void testLateOpen() {
+	std::string path = makeFifo("late");
+	{
+		//no reader - open fails by ENXIO, lines wait in the queue
+		UnixPipeAppender app(path);
+		CHECK(!app.isConnected());
+		app("first\n");
+		app("second\n");
+		std::this_thread::sleep_for(std::chrono::milliseconds(150));
+		CHECK(!app.isConnected());
+		CHECK(getStats(app).queue_depth == 2);
+		auto lines = connectAndRead(app, path);
+		CHECK(lines == std::vector<std::string>({"first", "second"}));
+		BackendStats st = getStats(app);
+		CHECK(st.dropped == 0);
+		CHECK(st.write_errors == 0);
+	}
+	::unlink(path.c_str());
+	//other errors are reported by the constructor
+	bool thrown = false;
+	try {
+		UnixPipeAppender app("/tmp/log4hpp-test-nonexistent-dir/pipe.fifo");
+	} catch (const std::system_error &e) {
+		thrown = e.code().value() == ENOENT;
+	}
+	CHECK(thrown);
+}
+
+void testDropNewest() {
+	std::string path = makeFifo("newest");
+	{
+		constexpr std::size_t count = 100;
+		UnixPipeAppender app(path, 4096, RecordQueue::Overflow::drop_newest);
+		for (std::size_t i = 0; i < count; i++) app(testLine("line", i), LineInfo{Level::info});
+		std::size_t dropped = getStats(app).dropped;
+		CHECK(dropped > 0 && dropped < count);
+		auto lines = connectAndRead(app, path);
+		//the notice is written before the first line, the oldest lines are kept
+		CHECK(lines.size() == count - dropped + 1);
+		if (lines.size() == count - dropped + 1) {
+			CHECK(noticeCount(lines[0]) == static_cast<long>(dropped));
+			for (std::size_t i = 1; i < lines.size(); i++) {
+				CHECK(lines[i] + "\n" == testLine("line", i-1));
+			}
+		}
+	}
+	::unlink(path.c_str());
+}
+
+void testDropOldest() {
+	std::string path = makeFifo("oldest");
+	{
+		constexpr std::size_t count = 100;
+		UnixPipeAppender app(path, 4096, RecordQueue::Overflow::drop_oldest);
+		for (std::size_t i = 0; i < count; i++) app(testLine("line", i), LineInfo{Level::info});
+		std::size_t dropped = getStats(app).dropped;
+		CHECK(dropped > 0 && dropped < count);
+		auto lines = connectAndRead(app, path);
+		//the newest lines are kept
+		CHECK(lines.size() == count - dropped + 1);
+		if (lines.size() == count - dropped + 1) {
+			CHECK(noticeCount(lines[0]) == static_cast<long>(dropped));
+			for (std::size_t i = 1; i < lines.size(); i++) {
+				CHECK(lines[i] + "\n" == testLine("line", dropped + i - 1));
+			}
+		}
+	}
+	::unlink(path.c_str());
+}
+
+void testDropBelowLevel() {
+	std::string path = makeFifo("level");
+	{
+		constexpr std::size_t count = 100;
+		constexpr std::size_t errors = 5;
+		UnixPipeAppender app(path, 4096, RecordQueue::Overflow::drop_below_level, Level::warning);
+		for (std::size_t i = 0; i < count; i++) app(testLine("info", i), LineInfo{Level::info});
+		//important lines make space by dropping the oldest lines
+		for (std::size_t i = 0; i < errors; i++) app(testLine("error", i), LineInfo{Level::error});
+		std::size_t dropped = getStats(app).dropped;
+		auto lines = connectAndRead(app, path);
+		CHECK(lines.size() == count + errors - dropped + 1);
+		if (lines.size() == count + errors - dropped + 1) {
+			CHECK(noticeCount(lines[0]) == static_cast<long>(dropped));
+			for (std::size_t i = 0; i < errors; i++) {
+				CHECK(lines[lines.size() - errors + i] + "\n" == testLine("error", i));
+			}
+			for (std::size_t i = 1; i < lines.size() - errors; i++) {
+				CHECK(lines[i].compare(0, 5, "info ") == 0);
+			}
+		}
+	}
+	::unlink(path.c_str());
+}
+
+void testBlock() {
+	std::string path = makeFifo("block");
+	{
+		//nobody reads - the caller waits for the timeout, then the line is dropped
+		UnixPipeAppender app(path, 4096, RecordQueue::Overflow::block, Level::warning,
+				std::chrono::milliseconds(50));
+		std::size_t i = 0;
+		while (getStats(app).dropped == 0 && i < 100) {
+			auto start = Clock::now();
+			app(testLine("line", i++));
+			if (getStats(app).dropped) CHECK(Clock::now() - start >= std::chrono::milliseconds(40));
+		}
+		CHECK(getStats(app).dropped == 1);
+	}
+	{
+		//the reader connects later, the caller waits until the queue is drained
+		UnixPipeAppender app(path, 4096, RecordQueue::Overflow::block, Level::warning,
+				std::chrono::milliseconds(5000));
+		constexpr std::size_t count = 100;
+		std::string buff;
+		std::thread reader([&]{
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			int f = openReader(path);
+			CHECK(readPipeUntil(f, buff, testLine("line", count-1)));
+			::close(f);
+		});
+		for (std::size_t i = 0; i < count; i++) app(testLine("line", i));
+		reader.join();
+		CHECK(getStats(app).dropped == 0);
+		auto lines = splitLines(buff);
+		CHECK(lines.size() == count);
+		for (std::size_t i = 0; i < lines.size(); i++) CHECK(lines[i] + "\n" == testLine("line", i));
+	}
+	::unlink(path.c_str());
+}
+
+void testInterruptedLine() {
+	std::string path = makeFifo("partial");
+	{
+		//longer than the capacity of the pipe
+		std::string big = "begin" + std::string(1024*1024, 'x') + "end\n";
+		UnixPipeAppender app(path, 4*1024*1024);
+		int f = openReader(path);
+		CHECK(waitFor([&]{return app.isConnected();}));
+		app(big);
+		app("next\n");
+		//the reader goes away in the middle of the line
+		std::string buff;
+		CHECK(readPipeBytes(f, buff, 10000));
+		CHECK(buff.compare(0, 5, "begin") == 0);
+		::close(f);
+		CHECK(waitFor([&]{return !app.isConnected();}));
+		//the next reader gets the whole line again, not its rest
+		f = openReader(path);
+		buff.clear();
+		CHECK(readPipeUntil(f, buff, "next\n"));
+		CHECK(buff == big + "next\n");
+		::close(f);
+		CHECK(getStats(app).dropped == 0);
+	}
+	::unlink(path.c_str());
+}
+
+}
+
+int main() {
+	testLateOpen();
+	testDropNewest();
+	testDropOldest();
+	testDropBelowLevel();
+	testBlock();
+	testInterruptedLine();
+	return result("unix_pipe_appender");
+}
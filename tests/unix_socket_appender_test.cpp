@@ -0,0 +1,179 @@
+/*
+ * unix_socket_appender_test.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * Drives UnixSocketAppender against a temporary unix socket - framing, reconnect, drop counting
+ */
+
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../unix_socket_appender.h"
+#include "test_utils.h"
+
+using namespace log4hpp;
+using namespace log4hpp_test;
+
+namespace {
+
+class TestAppender: public UnixSocketAppender {
+public:
+	using UnixSocketAppender::UnixSocketAppender;
+	using UnixSocketAppender::stop;
+};
+
+std::string tempPath(const char *name) {
+	return "/tmp/log4hpp-test-" + std::to_string(::getpid()) + "-" + name + ".sock";
+}
+
+int listenUnix(const std::string &path, int type) {
+	::unlink(path.c_str());
+	int s = ::socket(AF_UNIX, type|SOCK_CLOEXEC, 0);
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+	if (::bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))) {
+		::close(s);
+		return -1;
+	}
+	if (type == SOCK_STREAM) ::listen(s, 4);
+	return s;
+}
+
+std::string recvDatagram(int s) {
+	pollfd pfd = {s, POLLIN, 0};
+	if (::poll(&pfd, 1, 5000) != 1) return std::string();
+	char buff[4096];
+	auto r = ::recv(s, buff, sizeof(buff), 0);
+	return r > 0?std::string(buff, r):std::string();
+}
+
+bool endsWith(const std::string &s, const std::string &tail) {
+	return s.size() >= tail.size() && s.compare(s.size()-tail.size(), tail.size(), tail) == 0;
+}
+
+void testDatagram() {
+	std::string path = tempPath("dgram");
+	int s = listenUnix(path, SOCK_DGRAM);
+	CHECK(s >= 0);
+	std::string tail = " test[" + std::to_string(::getpid()) + "]: ";
+	{
+		UnixSocketAppender app(path, UnixSocketAppender::Type::datagram,
+				UnixSocketAppender::Format::rfc3164, "test");
+		app("hello\n", LineInfo{Level::error});
+		app("world");
+		std::string d1 = recvDatagram(s);
+		std::string d2 = recvDatagram(s);
+		//one line per datagram, trailing newline is removed
+		CHECK(d1.compare(0, 4, "<11>") == 0);
+		CHECK(endsWith(d1, tail + "hello"));
+		CHECK(d2.compare(0, 4, "<13>") == 0);
+		CHECK(endsWith(d2, tail + "world"));
+		BackendStats st = {};
+		app.stats(st);
+		CHECK(st.dropped == 0);
+		CHECK(st.write_errors == 0);
+	}
+	::close(s);
+	::unlink(path.c_str());
+}
+
+void testStreamOctetCounting() {
+	std::string path = tempPath("stream");
+	int s = listenUnix(path, SOCK_STREAM);
+	CHECK(s >= 0);
+	{
+		UnixSocketAppender app(path, UnixSocketAppender::Type::stream,
+				UnixSocketAppender::Format::rfc5424, "test");
+		int c = acceptTimeout(s);
+		CHECK(c >= 0);
+		app("first line\n");
+		app("second");
+		std::string buff;
+		std::size_t pos = 0;
+		std::string msgs[2];
+		for (auto &m: msgs) {
+			//MSG-LEN SP SYSLOG-MSG
+			CHECK(readUntil(c, buff, " "));
+			std::size_t sp = buff.find(' ', pos);
+			std::size_t len = std::stoul(buff.substr(pos, sp-pos));
+			CHECK(readBytes(c, buff, sp+1+len));
+			m = buff.substr(sp+1, len);
+			pos = sp+1+len;
+		}
+		CHECK(buff.size() == pos);
+		CHECK(msgs[0].compare(0, 6, "<13>1 ") == 0);
+		CHECK(endsWith(msgs[0], " - - first line"));
+		CHECK(endsWith(msgs[1], " - - second"));
+		::close(c);
+	}
+	::close(s);
+	::unlink(path.c_str());
+}
+
+void testReconnect() {
+	std::string path = tempPath("reconnect");
+	int s = listenUnix(path, SOCK_STREAM);
+	CHECK(s >= 0);
+	{
+		TestAppender app(path, UnixSocketAppender::Type::stream,
+				UnixSocketAppender::Format::rfc3164, "test");
+		int c = acceptTimeout(s);
+		CHECK(c >= 0);
+		app("one");
+		std::string buff;
+		CHECK(readUntil(c, buff, ": one\n"));
+		//the reader goes away, the line must be delivered through a new connection
+		::close(c);
+		app("two");
+		c = acceptTimeout(s);
+		CHECK(c >= 0);
+		buff.clear();
+		CHECK(readUntil(c, buff, ": two\n"));
+		CHECK(buff.find(": one\n") == buff.npos);
+		BackendStats st = {};
+		app.stats(st);
+		CHECK(st.write_errors >= 1);
+		CHECK(st.dropped == 0);
+		app.stop();
+		::close(c);
+	}
+	::close(s);
+	::unlink(path.c_str());
+}
+
+void testDropCount() {
+	std::string path = tempPath("nobody");
+	::unlink(path.c_str());
+	constexpr std::size_t count = 200;
+	TestAppender app(path, UnixSocketAppender::Type::datagram,
+			UnixSocketAppender::Format::rfc3164, "test", 1, 4096);
+	std::string line(100, 'x');
+	for (std::size_t i = 0; i < count; i++) app(line);
+	BackendStats st = {};
+	app.stats(st);
+	//nothing can be sent, lines are either queued or dropped by the overflow policy
+	CHECK(st.dropped > 0);
+	CHECK(st.dropped + st.queue_depth == count);
+	CHECK(!app.isConnected());
+	//lines left in the queue are counted as dropped when the appender stops
+	app.stop();
+	st = {};
+	app.stats(st);
+	CHECK(st.dropped == count);
+}
+
+}
+
+int main() {
+	testDatagram();
+	testStreamOctetCounting();
+	testReconnect();
+	testDropCount();
+	return result("unix_socket_appender");
+}
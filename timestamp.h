@@ -0,0 +1,205 @@
+/*
+ * timestamp.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_TIMESTAMP_H_
+#define LOG4HPP_TIMESTAMP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(LOG4HPP_NO_TSC)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define LOG4HPP_HAS_TSC 1
+#endif
+
+namespace log4hpp {
+
+///Cheap timestamp captured at the call site
+/**
+ * The timestamp is a raw counter - TSC (when the CPU has invariant TSC) or CLOCK_MONOTONIC_RAW in
+ * nanoseconds. The counter is converted to the wall-clock time only when the line is rendered.
+ * The conversion is calibrated against CLOCK_REALTIME. The anchor is refreshed by the converting
+ * thread, when it is older than a second, so the converted time follows adjustments of the system
+ * clock. With TSC, the frequency is measured since the first calibration, the anchor is refreshed
+ * more often until the measured period reaches a second. No background thread is started.
+ *
+ * Define LOG4HPP_NO_TSC to always use the clock_gettime()
+ */
+class Timestamp {
+public:
+	using Tick = std::uint64_t;
+
+	///Captures the current counter
+	static Tick now() noexcept {
+#ifdef LOG4HPP_HAS_TSC
+		if (usesTSC()) return __rdtsc();
+#endif
+		return monotonic();
+	}
+
+	///Converts the counter to nanoseconds since epoch
+	static std::int64_t toRealtime(Tick t) noexcept;
+
+	///Performs the initial calibration (if not already done)
+	/** Called by Backend::install(), so the first log call doesn't wait for the calibration (about 20us) */
+	static void calibrate() {calibration();}
+
+	///Returns current time in nanoseconds since epoch (CLOCK_REALTIME)
+	static std::int64_t realtime() noexcept {
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+	///Returns true, if the timestamp uses TSC
+	static bool usesTSC() noexcept {
+#ifdef LOG4HPP_HAS_TSC
+		static const bool tsc = detectTSC();
+		return tsc;
+#else
+		return false;
+#endif
+	}
+
+protected:
+
+	static std::int64_t monotonic() noexcept {
+		struct timespec ts;
+#ifdef CLOCK_MONOTONIC_RAW
+		clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+		return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+#ifdef LOG4HPP_HAS_TSC
+	static bool detectTSC() noexcept {
+		unsigned int a,b,c,d;
+		if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) return false;
+		__get_cpuid(0x80000007, &a, &b, &c, &d);
+		return (d & (1U << 8)) != 0;
+	}
+#endif
+
+	///Conversion from ticks to the wall-clock time (seqlock protected)
+	struct Calibration {
+		///sequence number (odd while updating)
+		std::atomic<unsigned int> seq = {0};
+		///ticks of the anchor
+		std::atomic<Tick> tick0 = {0};
+		///realtime of the anchor
+		std::atomic<std::int64_t> real0 = {0};
+		///nanoseconds per tick - fixed point 32.32
+		std::atomic<std::uint64_t> mult = {std::uint64_t(1) << 32};
+		///anchor is being refreshed
+		std::atomic<bool> updating = {false};
+		///reference point for measuring frequency
+		Tick tickRef = 0;
+		std::int64_t monoRef = 0;
+		///ticks between refreshes of the anchor
+		std::atomic<std::uint64_t> refreshTicks = {1000000000};
+
+		Calibration();
+		void refresh() noexcept;
+	};
+
+	static Calibration &calibration() {
+		//trivially destructible - it can be used by late log calls during the exit
+		static Calibration c;
+		return c;
+	}
+
+	static std::int64_t scale(std::int64_t diff, std::uint64_t mult) noexcept {
+#ifdef __SIZEOF_INT128__
+		return static_cast<std::int64_t>((static_cast<__int128>(diff) * mult) >> 32);
+#else
+		return static_cast<std::int64_t>(static_cast<long double>(diff) * mult / 4294967296.0L);
+#endif
+	}
+
+	///Reads the counter and the clock at the same moment (minimum of several attempts)
+	template<typename Fn>
+	static void samplePair(Tick &tick, std::int64_t &clk, Fn &&clock) noexcept {
+		Tick best = ~Tick(0);
+		for (int i = 0; i < 5; i++) {
+			Tick a = now();
+			std::int64_t c = clock();
+			Tick b = now();
+			if (b - a < best) {
+				best = b - a;
+				tick = a + (b - a) / 2;
+				clk = c;
+			}
+		}
+	}
+};
+
+inline Timestamp::Calibration::Calibration() {
+	if (usesTSC()) {
+		samplePair(tickRef, monoRef, monotonic);
+		//short initial measurement, the frequency is refined by each refresh
+		std::int64_t until = monoRef + 20000;
+		while (monotonic() < until) {}
+	}
+	refresh();
+}
+
+inline void Timestamp::Calibration::refresh() noexcept {
+	std::uint64_t m = std::uint64_t(1) << 32;
+	if (usesTSC()) {
+		Tick t = 0;
+		std::int64_t mono = 0;
+		samplePair(t, mono, monotonic);
+		if (t > tickRef && mono > monoRef) {
+			m = static_cast<std::uint64_t>((static_cast<long double>(mono - monoRef) * 4294967296.0L) / (t - tickRef));
+		}
+		//error of the frequency is given by the measured period, the anchor is not used
+		//longer than the period (up to a second)
+		if (m) refreshTicks.store(std::min((std::uint64_t(1000000000) << 32) / m, t - tickRef), std::memory_order_relaxed);
+	}
+	Tick t = 0;
+	std::int64_t real = 0;
+	samplePair(t, real, realtime);
+	unsigned int s = seq.load(std::memory_order_relaxed);
+	seq.store(s+1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	tick0.store(t, std::memory_order_relaxed);
+	real0.store(real, std::memory_order_relaxed);
+	mult.store(m, std::memory_order_relaxed);
+	seq.store(s+2, std::memory_order_release);
+}
+
+inline std::int64_t Timestamp::toRealtime(Tick t) noexcept {
+	Calibration &c = calibration();
+	//the anchor is refreshed by a single thread, other threads use the previous anchor meanwhile
+	Tick last = c.tick0.load(std::memory_order_relaxed);
+	if (t > last && t - last > c.refreshTicks.load(std::memory_order_relaxed)
+			&& !c.updating.exchange(true, std::memory_order_acquire)) {
+		c.refresh();
+		c.updating.store(false, std::memory_order_release);
+	}
+	Tick t0;
+	std::int64_t r0;
+	std::uint64_t m;
+	unsigned int s;
+	do {
+		s = c.seq.load(std::memory_order_acquire);
+		t0 = c.tick0.load(std::memory_order_relaxed);
+		r0 = c.real0.load(std::memory_order_relaxed);
+		m = c.mult.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((s & 1) || s != c.seq.load(std::memory_order_relaxed));
+	return r0 + scale(static_cast<std::int64_t>(t - t0), m);
+}
+
+}
+
+#endif /* LOG4HPP_TIMESTAMP_H_ */
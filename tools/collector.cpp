@@ -0,0 +1,110 @@
+/*
+ * collector.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * log4hpp-collector - drains the shared memory ring (ShmRingAppender) and writes lines
+ * through UnixFileRotatedAppender
+ *
+ * usage: log4hpp-collector [-d days] [-s size] [-u] <shm-name> <log-path>
+ *
+ * -d days  days to keep rotated files (default 7)
+ * -s size  capacity of the ring, if the collector creates it (default 4MB)
+ * -u       unlink the shared memory object on exit
+ */
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../shm_ring.h"
+#include "../unix_file_rotate_appender.h"
+
+namespace {
+
+std::atomic<bool> stopFlag = {false};
+
+void onSignal(int) {
+	stopFlag = true;
+}
+
+void usage() {
+	std::fprintf(stderr, "usage: log4hpp-collector [-d days] [-s size] [-u] <shm-name> <log-path>\n");
+}
+
+}
+
+int main(int argc, char **argv) {
+	unsigned long days = 7;
+	std::size_t size = 4*1024*1024;
+	bool unlinkOnExit = false;
+	std::vector<std::string> args;
+	for (int i = 1; i < argc; i++) {
+		std::string a(argv[i]);
+		if (a == "-d" && i+1 < argc) days = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-s" && i+1 < argc) size = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-u") unlinkOnExit = true;
+		else if (!a.empty() && a[0] == '-' && a.size() > 1) {usage(); return 1;}
+		else args.push_back(a);
+	}
+	if (args.size() != 2) {
+		usage();
+		return 1;
+	}
+
+	std::signal(SIGINT, &onSignal);
+	std::signal(SIGTERM, &onSignal);
+
+	try {
+		log4hpp::ShmRing ring(args[0], log4hpp::ShmRing::Role::consumer, size);
+		log4hpp::UnixFileRotatedAppender out(args[1], days);
+		std::uint64_t reportedDropped = ring.getDropped();
+		std::uint64_t reportedLost = ring.getLost();
+		std::string batch;
+		unsigned int idle = 0;
+
+		auto report = [&]{
+			auto d = ring.getDropped();
+			auto l = ring.getLost();
+			if (d != reportedDropped || l != reportedLost) {
+				char buff[200];
+				int n = std::snprintf(buff, sizeof(buff),
+						"log4hpp-collector: %llu records dropped (ring full), %llu incomplete records lost\n",
+						static_cast<unsigned long long>(d - reportedDropped),
+						static_cast<unsigned long long>(l - reportedLost));
+				out(std::string_view(buff, n));
+				reportedDropped = d;
+				reportedLost = l;
+			}
+		};
+
+		while (true) {
+			bool stop = stopFlag.load();
+			batch.clear();
+			auto cnt = ring.drain([&](const std::string_view &rec){
+				batch.append(rec);
+			}, 4096);
+			if (!batch.empty()) out(batch);
+			report();
+			if (cnt) {
+				idle = 0;
+			} else {
+				if (stop) break;
+				//adaptive sleep, the producer never signals the collector
+				if (idle < 10) ++idle;
+				std::this_thread::sleep_for(std::chrono::microseconds(100 << idle));
+			}
+		}
+		if (unlinkOnExit) log4hpp::ShmRing::unlink(args[0]);
+	} catch (const std::exception &e) {
+		std::fprintf(stderr, "log4hpp-collector: %s\n", e.what());
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * merge.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * log4hpp-merge - merges log files (segments of UnixSegmentAppender) into single stream ordered
+ * by the time or by the message number
+ *
+ * usage: log4hpp-merge [-m time|num] [-t field] [-n field] [-b base] [-o output] <files...>
+ *
+ * -m mode    ordering: time - by the time field (default), num - by the message number {N}
+ * -t field   position of the time field (1-based, fields are separated by spaces, default 2)
+ * -n field   position of the message number {N} (default 1)
+ * -b base    base of the message number (10, 16, 32, 62 - see format of unsigned numbers, default 10)
+ * -o output  output file (default stdout)
+ *
+ * Time field is compared as text (ISO 8601 format is expected), it must contain fraction of
+ * the second ({t[%FT%T.%NZ]}), inputs with second resolution are rejected, because their lines
+ * can't be ordered. Message numbers are comparable between inputs only with Numbering::global or
+ * Numbering::hlc (block and thread numbering are per thread, use the time). Each input must be
+ * ordered, which is true for segments of single thread. When a line of an input goes back,
+ * the input can't be merged (groups of threads with thread numbering) - the merge continues,
+ * but exits with the code 4.
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+enum class Mode {
+	time,
+	num
+};
+
+struct Config {
+	Mode mode = Mode::time;
+	unsigned int timeField = 2;
+	unsigned int numField = 1;
+	unsigned int base = 10;
+};
+
+class Input {
+public:
+	Input(const char *name, FILE *f):name(name),f(f) {}
+	Input(Input &&other):name(other.name),f(other.f),buff(other.buff),buffSize(other.buffSize) {
+		other.f = nullptr;
+		other.buff = nullptr;
+	}
+	~Input() {
+		if (f) std::fclose(f);
+		std::free(buff);
+	}
+
+	///Reads next line, returns false at the end of file
+	bool next(const Config &cfg) {
+		auto r = getline(&buff, &buffSize, f);
+		if (r < 0) return false;
+		prevTime.assign(time);
+		prevNum = num;
+		line.assign(buff, r);
+		if (line.empty() || line.back() != '\n') line.push_back('\n');
+		if (cfg.mode == Mode::time) time = field(cfg.timeField);
+		else num = parseNumber(field(cfg.numField), cfg.base);
+		++lines;
+		return true;
+	}
+
+	///Returns true, if the current line goes before the previous line of the input
+	bool backwards(const Config &cfg) const {
+		if (lines < 2) return false;
+		if (cfg.mode == Mode::time) return time < std::string_view(prevTime);
+		else return num < prevNum;
+	}
+
+	///Returns true, if the time contains fraction of the second
+	bool hasFraction() const {
+		for (std::size_t i = 0; i+1 < time.size(); i++) {
+			if ((time[i] == '.' || time[i] == ',') && time[i+1] >= '0' && time[i+1] <= '9') return true;
+		}
+		return false;
+	}
+
+	const char *name;
+	FILE *f;
+	std::string line;
+	std::string_view time;
+	unsigned long long num = 0;
+	std::size_t lines = 0;
+
+protected:
+	char *buff = nullptr;
+	std::size_t buffSize = 0;
+	std::string prevTime;
+	unsigned long long prevNum = 0;
+
+	std::string_view field(unsigned int idx) const {
+		if (idx == 0) return std::string_view();
+		std::string_view l(line);
+		std::size_t p = 0;
+		while (true) {
+			while (p < l.size() && (l[p] == ' ' || l[p] == '\t')) ++p;
+			std::size_t e = p;
+			while (e < l.size() && l[e] != ' ' && l[e] != '\t' && l[e] != '\n') ++e;
+			if (--idx == 0 || e >= l.size()) return l.substr(p, e-p);
+			p = e;
+		}
+	}
+
+	static unsigned long long parseNumber(std::string_view txt, unsigned int base) {
+		unsigned long long r = 0;
+		for (char c: txt) {
+			unsigned int d;
+			if (c >= '0' && c <= '9') d = c - '0';
+			else if (c >= 'A' && c <= 'Z') d = c - 'A' + 10;
+			else if (c >= 'a' && c <= 'z') d = base <= 36?c - 'a' + 10:c - 'a' + 36;
+			else break;
+			if (d >= base) break;
+			r = r * base + d;
+		}
+		return r;
+	}
+};
+
+void usage() {
+	std::fprintf(stderr, "usage: log4hpp-merge [-m time|num] [-t field] [-n field] [-b base] [-o output] <files...>\n");
+}
+
+}
+
+int main(int argc, char **argv) {
+	Config cfg;
+	const char *output = nullptr;
+	std::vector<const char *> files;
+	for (int i = 1; i < argc; i++) {
+		std::string_view a(argv[i]);
+		if (a == "-m" && i+1 < argc) {
+			std::string_view m(argv[++i]);
+			if (m == "time") cfg.mode = Mode::time;
+			else if (m == "num") cfg.mode = Mode::num;
+			else {usage(); return 1;}
+		}
+		else if (a == "-t" && i+1 < argc) cfg.timeField = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-n" && i+1 < argc) cfg.numField = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-b" && i+1 < argc) cfg.base = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-o" && i+1 < argc) output = argv[++i];
+		else if (a.size() > 1 && a[0] == '-') {usage(); return 1;}
+		else files.push_back(argv[i]);
+	}
+	if (files.empty() || cfg.base < 2 || cfg.base > 62
+			|| (cfg.mode == Mode::time?cfg.timeField:cfg.numField) == 0) {
+		usage();
+		return 1;
+	}
+
+	FILE *out = stdout;
+	if (output) {
+		out = std::fopen(output, "w");
+		if (!out) {
+			std::fprintf(stderr, "Can't open %s: %s\n", output, std::strerror(errno));
+			return 2;
+		}
+	}
+
+	std::vector<Input> inputs;
+	inputs.reserve(files.size());
+	for (const char *name: files) {
+		FILE *f = std::fopen(name, "r");
+		if (!f) {
+			std::fprintf(stderr, "Can't open %s: %s\n", name, std::strerror(errno));
+			return 2;
+		}
+		inputs.emplace_back(name, f);
+	}
+
+	//min-heap of inputs ordered by the current line, equal lines are taken in order of inputs
+	auto greater = [&](std::size_t a, std::size_t b) {
+		const Input &x = inputs[a];
+		const Input &y = inputs[b];
+		if (cfg.mode == Mode::time) {
+			int c = x.time.compare(y.time);
+			if (c) return c > 0;
+		} else if (x.num != y.num) {
+			return x.num > y.num;
+		}
+		return a > b;
+	};
+	std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap(greater);
+	for (std::size_t i = 0; i < inputs.size(); i++) {
+		Input &in = inputs[i];
+		if (!in.next(cfg)) continue;
+		if (cfg.mode == Mode::time && !in.hasFraction()) {
+			std::fprintf(stderr, "%s: time field '%.*s' has no fraction of the second, lines can't be ordered. "
+					"Use {t[%%FT%%T.%%NZ]}, or -m num with Numbering::hlc\n",
+					in.name, static_cast<int>(in.time.size()), in.time.data());
+			return 4;
+		}
+		heap.push(i);
+	}
+	bool unordered = false;
+	while (!heap.empty()) {
+		std::size_t i = heap.top();
+		heap.pop();
+		Input &in = inputs[i];
+		std::fwrite(in.line.data(), 1, in.line.size(), out);
+		if (in.next(cfg)) {
+			if (in.backwards(cfg) && !unordered) {
+				std::fprintf(stderr, "%s:%zu: line goes back, the input is not ordered\n", in.name, in.lines);
+				unordered = true;
+			}
+			heap.push(i);
+		}
+	}
+	if (std::fflush(out)) {
+		std::fprintf(stderr, "Write error: %s\n", std::strerror(errno));
+		return 3;
+	}
+	if (out != stdout) std::fclose(out);
+	return unordered?4:0;
+}
@@ -0,0 +1,262 @@
+/*
+ * slice.cpp
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ *
+ * log4hpp-slice - extracts lines of a time range from log files, uses the sparse index
+ * (sidecar files <file>.idx written by UnixFileAppender::enable_index()) to skip
+ * the rest of the files
+ *
+ * usage: log4hpp-slice [--from time] [--to time] [-t field] [-s slack] [-o output] <files...>
+ *
+ * --from time  start of the range (including)
+ * --to time    end of the range (including)
+ * -t field     position of the time field in the line (1-based, default 2, 0 - don't filter lines,
+ *              output whole blocks found by the index)
+ * -s slack     maximum delay between the time of the line and its write in milliseconds (default 1000). Lines
+ *              are captured with the time of the call, a preempted thread writes the line later, so
+ *              the searched part of the file is extended by this time at both sides
+ * -o output    output file (default stdout)
+ *
+ * Time is in UTC in the format YYYY-MM-DDTHH:MM:SS[.fraction][Z] or @seconds since epoch. Files can
+ * be passed in any order (for example log/logfile*), they are processed from the oldest one, index
+ * files are ignored. Files without index are scanned completely
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../file_index.h"
+
+namespace {
+
+using log4hpp::FileIndex;
+
+///Parses time to nanoseconds since epoch
+bool parseTime(std::string_view txt, std::int64_t &ns) {
+	if (!txt.empty() && txt[0] == '@') {
+		char *end;
+		std::string s(txt.substr(1));
+		double v = std::strtod(s.c_str(), &end);
+		if (end == s.c_str()) return false;
+		ns = static_cast<std::int64_t>(v * 1e9);
+		return true;
+	}
+	if (txt.size() < 19) return false;
+	auto num = [&](std::size_t pos, std::size_t len, int &out) {
+		if (pos + len > txt.size()) return false;
+		int v = 0;
+		for (std::size_t i = pos; i < pos+len; i++) {
+			char c = txt[i];
+			if (c < '0' || c > '9') return false;
+			v = v * 10 + (c - '0');
+		}
+		out = v;
+		return true;
+	};
+	struct tm tm = {};
+	if (!num(0, 4, tm.tm_year) || txt[4] != '-' || !num(5, 2, tm.tm_mon) || txt[7] != '-'
+			|| !num(8, 2, tm.tm_mday) || (txt[10] != 'T' && txt[10] != ' ')
+			|| !num(11, 2, tm.tm_hour) || txt[13] != ':' || !num(14, 2, tm.tm_min) || txt[16] != ':'
+			|| !num(17, 2, tm.tm_sec)) return false;
+	tm.tm_year -= 1900;
+	tm.tm_mon -= 1;
+	std::int64_t frac = 0;
+	std::size_t p = 19;
+	if (p < txt.size() && (txt[p] == '.' || txt[p] == ',')) {
+		std::int64_t mult = 100000000;
+		++p;
+		while (p < txt.size() && txt[p] >= '0' && txt[p] <= '9') {
+			frac += (txt[p] - '0') * mult;
+			mult /= 10;
+			++p;
+		}
+	}
+	ns = static_cast<std::int64_t>(timegm(&tm)) * 1000000000 + frac;
+	return true;
+}
+
+///Returns n-th field of the line (separated by spaces)
+std::string_view field(std::string_view l, unsigned int idx) {
+	std::size_t p = 0;
+	while (true) {
+		while (p < l.size() && (l[p] == ' ' || l[p] == '\t')) ++p;
+		std::size_t e = p;
+		while (e < l.size() && l[e] != ' ' && l[e] != '\t' && l[e] != '\n') ++e;
+		if (--idx == 0 || e >= l.size()) return l.substr(p, e-p);
+		p = e;
+	}
+}
+
+///Read-only memory mapping of a file
+class Mapping {
+public:
+	Mapping() = default;
+	Mapping(const Mapping &) = delete;
+	Mapping &operator=(const Mapping &) = delete;
+	~Mapping() {
+		if (ptr) munmap(ptr, size);
+	}
+	bool open(const std::string &name) {
+		int fd = ::open(name.c_str(), O_RDONLY|O_CLOEXEC);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) || st.st_size == 0) {
+			::close(fd);
+			return st.st_size == 0;
+		}
+		size = st.st_size;
+		void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (p == MAP_FAILED) return false;
+		ptr = p;
+		return true;
+	}
+	const char *data() const {return static_cast<const char *>(ptr);}
+	std::size_t length() const {return ptr?size:0;}
+
+protected:
+	void *ptr = nullptr;
+	std::size_t size = 0;
+};
+
+///Finds part of the file, which can contain the range (using the index)
+void findRange(const std::string &name, std::size_t fileSize, std::int64_t from, std::int64_t to,
+		std::int64_t slack, std::size_t &start, std::size_t &end) {
+	start = 0;
+	end = fileSize;
+	Mapping idx;
+	if (!idx.open(name + FileIndex::suffix) || idx.length() < sizeof(FileIndex::magic)
+			|| std::memcmp(idx.data(), FileIndex::magic, sizeof(FileIndex::magic)) != 0) return;
+	std::size_t count = (idx.length() - sizeof(FileIndex::magic)) / sizeof(FileIndex::Entry);
+	if (count == 0) return;
+	std::vector<FileIndex::Entry> entries(count);
+	std::memcpy(entries.data(), idx.data() + sizeof(FileIndex::magic), count * sizeof(FileIndex::Entry));
+	//times are not strictly ordered (threads), the range is extended by the slack
+	std::int64_t sfrom = from > LLONG_MIN + slack?from - slack:LLONG_MIN;
+	std::int64_t sto = to < LLONG_MAX - slack?to + slack:LLONG_MAX;
+	auto first = std::partition_point(entries.begin(), entries.end(), [&](const FileIndex::Entry &e){
+		return e.time < sfrom;
+	});
+	if (first != entries.begin()) start = std::min<std::size_t>((first-1)->offset, fileSize);
+	auto last = std::partition_point(first, entries.end(), [&](const FileIndex::Entry &e){
+		return e.time <= sto;
+	});
+	if (last != entries.end()) end = std::min<std::size_t>(last->offset, fileSize);
+	if (end < start) end = start;
+}
+
+bool sliceFile(const std::string &name, std::int64_t from, std::int64_t to, std::int64_t slack,
+		unsigned int timeField, FILE *out) {
+	Mapping log;
+	if (!log.open(name)) {
+		std::fprintf(stderr, "Can't open %s: %s\n", name.c_str(), std::strerror(errno));
+		return false;
+	}
+	std::size_t start, end;
+	findRange(name, log.length(), from, to, slack, start, end);
+	const char *data = log.data();
+	if (timeField == 0) {
+		std::fwrite(data+start, 1, end-start, out);
+		return true;
+	}
+	//contiguous runs of matching lines are written at once
+	std::size_t runStart = start;
+	bool inRange = false;
+	std::size_t p = start;
+	while (p < end) {
+		const char *nl = static_cast<const char *>(std::memchr(data+p, '\n', end-p));
+		std::size_t e = nl?(nl - data) + 1:end;
+		std::string_view line(data+p, e-p);
+		std::int64_t tm;
+		//lines without time belong to the previous line
+		bool match = parseTime(field(line, timeField), tm)?(tm >= from && tm <= to):inRange;
+		if (match != inRange) {
+			if (inRange) std::fwrite(data+runStart, 1, p-runStart, out);
+			else runStart = p;
+			inRange = match;
+		}
+		p = e;
+	}
+	if (inRange) std::fwrite(data+runStart, 1, end-runStart, out);
+	return true;
+}
+
+void usage() {
+	std::fprintf(stderr, "usage: log4hpp-slice [--from time] [--to time] [-t field] [-s slack] [-o output] <files...>\n");
+}
+
+}
+
+int main(int argc, char **argv) {
+	std::int64_t from = LLONG_MIN;
+	std::int64_t to = LLONG_MAX;
+	unsigned int timeField = 2;
+	std::int64_t slack = 1000000000;
+	const char *output = nullptr;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; i++) {
+		std::string_view a(argv[i]);
+		if ((a == "--from" || a == "--to") && i+1 < argc) {
+			if (!parseTime(argv[++i], a == "--from"?from:to)) {
+				std::fprintf(stderr, "Invalid time: %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (a == "-t" && i+1 < argc) timeField = std::strtoul(argv[++i], nullptr, 10);
+		else if (a == "-s" && i+1 < argc) slack = static_cast<std::int64_t>(std::strtoul(argv[++i], nullptr, 10)) * 1000000;
+		else if (a == "-o" && i+1 < argc) output = argv[++i];
+		else if (a.size() > 1 && a[0] == '-') {usage(); return 1;}
+		else if (a.size() < 4 || a.substr(a.size()-4) != FileIndex::suffix) files.emplace_back(a);
+	}
+	if (files.empty()) {
+		usage();
+		return 1;
+	}
+
+	//oldest files first, files modified before the range are skipped
+	std::vector<std::pair<std::int64_t, std::string> > sorted;
+	for (auto &f: files) {
+		struct stat st;
+		if (stat(f.c_str(), &st)) {
+			std::fprintf(stderr, "Can't open %s: %s\n", f.c_str(), std::strerror(errno));
+			return 2;
+		}
+		std::int64_t mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+		if (mtime >= from) sorted.emplace_back(mtime, f);
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	FILE *out = stdout;
+	if (output) {
+		out = std::fopen(output, "w");
+		if (!out) {
+			std::fprintf(stderr, "Can't open %s: %s\n", output, std::strerror(errno));
+			return 2;
+		}
+	}
+	int ret = 0;
+	for (auto &f: sorted) {
+		if (!sliceFile(f.second, from, to, slack, timeField, out)) ret = 2;
+	}
+	if (std::fflush(out)) {
+		std::fprintf(stderr, "Write error: %s\n", std::strerror(errno));
+		return 3;
+	}
+	if (out != stdout) std::fclose(out);
+	return ret;
+}
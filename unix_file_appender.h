@@ -8,42 +8,130 @@
 #ifndef UNIX_FILE_APPENDER_H_
 #define UNIX_FILE_APPENDER_H_
 
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <signal.h>
 
+#include "config.h"
+#include "appender.h"
+#include "file_index.h"
+#include "stats.h"
+#include "unix_file_sync.h"
+
 namespace log4hpp {
 
 
 	class UnixFileAppender {
 	public:
 
-		UnixFileAppender(const std::string_view &pathname);
+		///Constructor
+		/**
+		 * @param pathname path to the file
+		 * @param durability durability policy (default - never sync)
+		 * @param syncer background sync thread shared with other appenders (nullptr - the appender
+		 * starts own thread, when the durability policy needs it)
+		 */
+		UnixFileAppender(const std::string_view &pathname, const Durability &durability = Durability(),
+				std::shared_ptr<FileSyncer> syncer = nullptr);
 		~UnixFileAppender();
 
 		void operator()(const std::string_view &line);
+		///Writes line, syncs the file, if the level requires it
+		/** The sync is performed outside of the lock, so other threads can write meanwhile. Files which
+		 * are not regular files (pipes, devices) are not synced */
+		void operator()(const std::string_view &line, const LineInfo &info);
 
 		void close();
 
+		///Enables sparse time index
+		/**
+		 * The index is written to the sidecar file `<pathname>.idx` (see FileIndex), each entry maps
+		 * the time and the message number to the offset of the line. The tool log4hpp-slice uses
+		 * the index to extract a time range without scanning whole file. Lines without time (lines
+		 * of the flight recorder) are not indexed
+		 *
+		 * @param records write an entry every N lines (0 - disabled)
+		 * @param bytes write an entry every N bytes (0 - disabled)
+		 */
+		void enable_index(std::size_t records = 1024, std::size_t bytes = 1024*1024);
+
+		///Writes line without locking (from the crash handler) - async-signal-safe
+		void crash_write(const std::string_view &line);
+
+		///Syncs the file from the crash handler (only when durability is enabled) - async-signal-safe
+		void crash_flush();
+
+		///Adds counters of the appender to the statistics
+		void stats(BackendStats &st) const {
+			st.write_errors += write_errors.load(std::memory_order_relaxed);
+			//errors of the shared thread are reported by the owner of the thread
+			if (syncer && !sharedSyncer) st.write_errors += syncer->errors();
+			st.dropped += dropped.load(std::memory_order_relaxed);
+		}
+
+		///Returns true, if the appender needs the time of the message (the time index)
+		bool needs_time() const {return index_enabled();}
+
+		///Returns errno of the last failed write or open (0 if there were no error)
+		int get_last_error() const {return last_error.load(std::memory_order_relaxed);}
+
 	protected:
 		std::string pathname;
 		int fd = -1;
+		///the file is a regular file (it can be synced)
+		bool regular = false;
 		std::size_t inst;
 		std::mutex lock;
+		std::atomic<std::size_t> write_errors = {0};
+		std::atomic<std::size_t> dropped = {0};
+		std::atomic<int> last_error = {0};
+		Durability durability;
+		///the sync thread is shared with other appenders
+		bool sharedSyncer;
+		std::shared_ptr<FileSyncer> syncer;
+		int idx_fd = -1;
+		std::size_t idx_records = 0;
+		std::size_t idx_bytes = 0;
+		///lines since the last index entry
+		std::size_t idx_lines = 0;
+		///bytes since the last index entry
+		std::size_t idx_size = 0;
+		///next line starts new index entry
+		bool idx_first = true;
 
 		bool open_file();
 		std::size_t send(const std::string_view &line);
 
-		void send_line_lk(const std::string_view &line);
+		void send_line_lk(const std::string_view &line, const LineInfo &info = LineInfo());
+		void close_lk();
+		///Returns duplicate of the descriptor for the sync outside of the lock (-1 - nothing to sync)
+		int sync_fd_lk();
+		///Syncs and closes the duplicate of the descriptor
+		void sync(int f);
+		bool index_enabled() const {return idx_records || idx_bytes;}
+		void open_index_lk();
+		void index_lk(const std::string_view &line, const LineInfo &info);
 	};
 
 
 
-inline UnixFileAppender::UnixFileAppender(const std::string_view &pathname)
+#ifdef LOG4HPP_WITH_IMPL
+
+LOG4HPP_IMPL UnixFileAppender::UnixFileAppender(const std::string_view &pathname, const Durability &durability,
+		std::shared_ptr<FileSyncer> syncer)
 :pathname(pathname)
  ,fd(-1)
+ ,durability(durability)
+ ,sharedSyncer(syncer != nullptr)
+ ,syncer(syncer?std::move(syncer):durability.background()?std::make_shared<FileSyncer>(durability):nullptr)
 {
 	if (!open_file()) {
 		int e = errno;
@@ -54,66 +142,186 @@ inline UnixFileAppender::UnixFileAppender(const std::string_view &pathname)
 }
 
 
-inline UnixFileAppender::~UnixFileAppender() {
+LOG4HPP_IMPL UnixFileAppender::~UnixFileAppender() {
+	if (syncer) syncer->set_file(-1, this);
 	if (fd>=0) ::close(fd);
+	if (idx_fd>=0) ::close(idx_fd);
 }
 
-inline void UnixFileAppender::operator ()(const std::string_view &line) {
+LOG4HPP_IMPL void UnixFileAppender::operator ()(const std::string_view &line) {
 	std::lock_guard _(lock);
 	send_line_lk(line);
 }
 
-inline void UnixFileAppender::send_line_lk(const std::string_view &line) {
+LOG4HPP_IMPL void UnixFileAppender::operator ()(const std::string_view &line, const LineInfo &info) {
+	int f = -1;
+	{
+		std::lock_guard _(lock);
+		send_line_lk(line, info);
+		if (durability.syncOnLevel(info.level)) f = sync_fd_lk();
+	}
+	if (f >= 0) sync(f);
+}
+
+LOG4HPP_IMPL void UnixFileAppender::send_line_lk(const std::string_view &line, const LineInfo &info) {
 	if (fd<0) {
 		if (!open_file()) {
-				return;
+			last_error = errno;
+			++dropped;
+			return;
 		}
 	}
+	if (idx_fd>=0) index_lk(line, info);
 	auto sz = send(line);
 	if (sz<line.size()) {
-		if (sz) operator()(line.substr(sz));
+		//write failed, file was closed - reopen and try to write the rest once
+		if (!open_file()) {
+			last_error = errno;
+			++dropped;
+			return;
+		}
+		if (send(line.substr(sz)) < line.size()-sz) {
+			++dropped;
+			return;
+		}
+	}
+	if (syncer) syncer->written(line.size());
+}
+
+LOG4HPP_IMPL int UnixFileAppender::sync_fd_lk() {
+	//the file can be closed or reopened by other thread during the sync
+	return fd >= 0 && regular?::fcntl(fd, F_DUPFD_CLOEXEC, 0):-1;
+}
+
+LOG4HPP_IMPL void UnixFileAppender::sync(int f) {
+	if (::fdatasync(f)) {
+		last_error = errno;
+		++write_errors;
 	}
+	::close(f);
 }
 
-inline bool UnixFileAppender::open_file() {
+LOG4HPP_IMPL bool UnixFileAppender::open_file() {
 	fd = ::open(pathname.c_str(), O_WRONLY|O_APPEND|O_CREAT|O_CLOEXEC|O_NONBLOCK, 0666);
 	if (fd < 0) return false;
 	struct stat st;
-	if (!fstat(fd,&st)) {
-		if ((st.st_mode & S_IFMT) != S_IFREG) {
-			signal(SIGPIPE, SIG_IGN);
-			int opt = fcntl(fd, F_GETFL);
-			opt = opt & ~O_NONBLOCK;
-			fcntl(fd, F_SETFL,  opt);
-		}
+	regular = !fstat(fd,&st) && (st.st_mode & S_IFMT) == S_IFREG;
+	if (!regular) {
+		signal(SIGPIPE, SIG_IGN);
+		int opt = fcntl(fd, F_GETFL);
+		opt = opt & ~O_NONBLOCK;
+		fcntl(fd, F_SETFL,  opt);
 	}
+	//fdatasync() of a pipe or a device fails
+	if (syncer) syncer->set_file(regular?fd:-1, this);
+	if (index_enabled()) open_index_lk();
 	return true;
 }
 
-inline void UnixFileAppender::close() {
+LOG4HPP_IMPL void UnixFileAppender::enable_index(std::size_t records, std::size_t bytes) {
+	std::lock_guard _(lock);
+	idx_records = records;
+	idx_bytes = bytes;
+	if (fd>=0 && index_enabled() && idx_fd<0) open_index_lk();
+}
+
+LOG4HPP_IMPL void UnixFileAppender::open_index_lk() {
+	if (idx_fd>=0) ::close(idx_fd);
+	std::string name(pathname);
+	name.append(FileIndex::suffix);
+	idx_fd = ::open(name.c_str(), O_WRONLY|O_APPEND|O_CREAT|O_CLOEXEC, 0666);
+	if (idx_fd<0) return;
+	struct stat st;
+	if (!fstat(idx_fd, &st) && st.st_size == 0) {
+		if (::write(idx_fd, FileIndex::magic, sizeof(FileIndex::magic)) != sizeof(FileIndex::magic)) {
+			::close(idx_fd);
+			idx_fd = -1;
+			return;
+		}
+	}
+	idx_first = true;
+}
+
+LOG4HPP_IMPL void UnixFileAppender::index_lk(const std::string_view &line, const LineInfo &info) {
+	if (info.time && (idx_first
+			|| (idx_records && idx_lines >= idx_records)
+			|| (idx_bytes && idx_size >= idx_bytes))) {
+		//other processes can append to the same file, so the offset is taken from the file
+		auto off = ::lseek(fd, 0, SEEK_END);
+		if (off >= 0) {
+			FileIndex::Entry e{info.time, info.seq, static_cast<std::uint64_t>(off)};
+			if (::write(idx_fd, &e, sizeof(e)) == sizeof(e)) {
+				idx_first = false;
+				idx_lines = 0;
+				idx_size = 0;
+			}
+		}
+	}
+	++idx_lines;
+	idx_size += line.size();
+}
+
+LOG4HPP_IMPL void UnixFileAppender::close() {
 	std::lock_guard _(lock);
+	close_lk();
+}
+
+LOG4HPP_IMPL void UnixFileAppender::close_lk() {
 	if (fd>=0) {
 		::close(fd);
 		fd = -1;
 	}
+	if (idx_fd>=0) {
+		::close(idx_fd);
+		idx_fd = -1;
+	}
 }
 
-inline std::size_t UnixFileAppender::send(const std::string_view &line) {
-	int s = ::write(fd, line.data(), line.size());
-	if (s <= 0) {
-		::close(fd);
-		fd = -1;
-		return 0;
-	} else  {
-		if (static_cast<std::size_t>(s) < line.size())
-			return s+send(line.substr(s));
-		else
-			return s;
+LOG4HPP_IMPL void UnixFileAppender::crash_write(const std::string_view &line) {
+	int f = fd;
+	if (f < 0) f = STDERR_FILENO;
+	std::size_t p = 0;
+	while (p < line.size()) {
+		auto s = ::write(f, line.data()+p, line.size()-p);
+		if (s <= 0) break;
+		p+=s;
 	}
 }
 
+LOG4HPP_IMPL void UnixFileAppender::crash_flush() {
+	int f = fd;
+	if (f >= 0 && regular && (syncer || durability.syncLevel != Level::nolevel)) ::fdatasync(f);
+}
+
+LOG4HPP_IMPL std::size_t UnixFileAppender::send(const std::string_view &line) {
+	std::size_t p = 0;
+	while (p < line.size()) {
+		auto s = ::write(fd, line.data()+p, line.size()-p);
+		if (s <= 0) {
+			last_error = s<0?errno:EIO;
+			++write_errors;
+			::close(fd);
+			fd = -1;
+			break;
+		}
+		p += s;
+	}
+	return p;
+}
+
+
+
+#endif
 
 }
 
 
+#ifdef LOG4HPP_COMPILED
+#include "backend_impl.h"
+
+namespace log4hpp {
+LOG4HPP_EXTERN template class BackendT<UnixFileAppender>;
+}
+#endif
+
 #endif /* UNIX_FILE_APPENDER_H_ */
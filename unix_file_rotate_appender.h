@@ -11,54 +11,140 @@
 
 #include <cstring>
 #include <dirent.h>
+#include <sys/file.h>
 #include <algorithm>
+#include "config.h"
+#include "timestamp.h"
 #include "unix_file_appender.h"
 
 namespace log4hpp {
 
+///File appender which rotates the file every day (or other period)
+/**
+ * More processes can share the same pathname. Rotation is serialized by flock() on the file
+ * `<pathname>.lock`, exactly one process renames the file and prunes old files. Other processes
+ * detect that the file has been replaced (inode check, once per second) and reopen it.
+ */
 class UnixFileRotatedAppender: public UnixFileAppender {
 public:
-	UnixFileRotatedAppender(const std::string_view &pathname, unsigned long days = 7, unsigned long day_seconds = 24*60*60, const std::string_view &dateformat="%Y%m%d");
+	UnixFileRotatedAppender(const std::string_view &pathname, unsigned long days = 7, unsigned long day_seconds = 24*60*60, const std::string_view &dateformat="%Y%m%d",
+			const Durability &durability = Durability(), std::shared_ptr<FileSyncer> syncer = nullptr);
 
 	void operator()(const std::string_view &line);
+	void operator()(const std::string_view &line, const LineInfo &info);
+
+	///The period of the file is given by the time of the message
+	bool needs_time() const {return true;}
+
+	~UnixFileRotatedAppender();
 
 protected:
 	unsigned long days;
 	unsigned long day_seconds;
 	unsigned long cur_day;
 	std::string dateformat;
+	///lock file, which serializes rotation between processes (opened on first rotation)
+	int lock_fd = -1;
+	///time of the last check of the file
+	std::time_t last_check = 0;
 
 	void do_rotate(std::time_t tm);
+	void check_rotate_lk(std::int64_t time);
+	void rotate_lk();
+	bool file_replaced_lk() const;
 
 };
 
-log4hpp::UnixFileRotatedAppender::UnixFileRotatedAppender(
-		const std::string_view &pathname, unsigned long days, unsigned long day_seconds,const std::string_view &dateformat)
-:UnixFileAppender(pathname),days(days),day_seconds(day_seconds), cur_day(0),dateformat(dateformat)
+#ifdef LOG4HPP_WITH_IMPL
+
+LOG4HPP_IMPL log4hpp::UnixFileRotatedAppender::UnixFileRotatedAppender(
+		const std::string_view &pathname, unsigned long days, unsigned long day_seconds,const std::string_view &dateformat,
+		const Durability &durability, std::shared_ptr<FileSyncer> syncer)
+:UnixFileAppender(pathname, durability, std::move(syncer)),days(days),day_seconds(day_seconds), cur_day(0),dateformat(dateformat)
 {
+	//period of the existing file is taken from its last modification
+	struct stat st;
+	if (fd>=0 && !fstat(fd, &st) && st.st_size > 0) cur_day = st.st_mtime/day_seconds;
+	else cur_day = std::time(nullptr)/day_seconds;
 }
 
-inline void log4hpp::UnixFileRotatedAppender::operator ()(const std::string_view &line) {
+LOG4HPP_IMPL log4hpp::UnixFileRotatedAppender::~UnixFileRotatedAppender() {
+	if (lock_fd>=0) ::close(lock_fd);
+}
+
+LOG4HPP_IMPL void log4hpp::UnixFileRotatedAppender::operator ()(const std::string_view &line) {
 	std::lock_guard _(lock);
-	auto now = std::time(nullptr);
+	check_rotate_lk(Timestamp::realtime());
+	send_line_lk(line);
+}
+
+LOG4HPP_IMPL void log4hpp::UnixFileRotatedAppender::operator ()(const std::string_view &line, const LineInfo &info) {
+	int f = -1;
+	{
+		std::lock_guard _(lock);
+		//the time of the message decides, so the line is in the file of its period
+		check_rotate_lk(info.time?info.time:Timestamp::realtime());
+		send_line_lk(line, info);
+		if (durability.syncOnLevel(info.level)) f = sync_fd_lk();
+	}
+	if (f >= 0) sync(f);
+}
+
+LOG4HPP_IMPL void log4hpp::UnixFileRotatedAppender::check_rotate_lk(std::int64_t time) {
+	std::time_t now = static_cast<std::time_t>(time / 1000000000);
+	//the file is checked at most once per second
+	if (now == last_check) return;
+	last_check = now;
 	unsigned long day = now/day_seconds;
-	if (day != cur_day) {
-		do_rotate(now - day_seconds);
+	//a delayed message of the previous period doesn't rotate back
+	if (day > cur_day) {
+		rotate_lk();
 		cur_day = day;
+	} else if (file_replaced_lk()) {
+		//other process rotated the file (or logrotate), reopen it
+		close_lk();
 	}
-	send_line_lk(line);
 }
 
-inline void log4hpp::UnixFileRotatedAppender::do_rotate(std::time_t tm) {
+LOG4HPP_IMPL bool log4hpp::UnixFileRotatedAppender::file_replaced_lk() const {
+	if (fd<0) return false;
+	struct stat cur, path;
+	if (fstat(fd, &cur)) return false;
+	if ((cur.st_mode & S_IFMT) != S_IFREG) return false;
+	if (stat(pathname.c_str(), &path)) return true;
+	return cur.st_ino != path.st_ino || cur.st_dev != path.st_dev;
+}
+
+LOG4HPP_IMPL void log4hpp::UnixFileRotatedAppender::rotate_lk() {
+	if (lock_fd<0) {
+		std::string name(pathname);
+		name.append(".lock");
+		lock_fd = ::open(name.c_str(), O_RDWR|O_CREAT|O_CLOEXEC, 0666);
+	}
+	//without the lock file, the rotation works as in single process
+	bool locked = lock_fd>=0 && flock(lock_fd, LOCK_EX) == 0;
+	if (file_replaced_lk()) {
+		close_lk();
+	} else {
+		do_rotate(static_cast<std::time_t>(cur_day*day_seconds));
+	}
+	if (locked) flock(lock_fd, LOCK_UN);
+}
+
+LOG4HPP_IMPL void log4hpp::UnixFileRotatedAppender::do_rotate(std::time_t tm) {
 	std::string name;
 	name.append(pathname);
 	name.push_back('-');
 	auto pos = name.size();
 	name.resize(pos+5*dateformat.size());
-	std::strftime(name.data()+pos, name.size()-pos, dateformat.c_str(), gmtime(&tm));
+	struct tm tmbuf;
+	name.resize(pos+std::strftime(name.data()+pos, name.size()-pos, dateformat.c_str(), gmtime_r(&tm, &tmbuf)));
 	if (access(name.c_str(),F_OK) == 0) return;
-	close();
+	close_lk();
 	rename(pathname.c_str(), name.c_str());
+	if (index_enabled()) {
+		rename((pathname + FileIndex::suffix).c_str(), (name + FileIndex::suffix).c_str());
+	}
 	if (days > 0) {
 		auto sep = name.rfind('/');
 		std::string base = pathname.substr(sep+1);
@@ -68,9 +154,14 @@ inline void log4hpp::UnixFileRotatedAppender::do_rotate(std::time_t tm) {
 			try {
 				std::vector<std::pair<time_t,std::string> > files;
 				struct dirent *entry;
+				auto endsWith = [](const std::string_view &n, const std::string_view &suffix) {
+					return n.size() >= suffix.size() && n.substr(n.size()-suffix.size()) == suffix;
+				};
 				while ((entry=readdir(d)) != nullptr) {
 					std::string_view ename(entry->d_name, strlen(entry->d_name));
-					if (ename.substr(0, base.size()) == base) {
+					//index files are removed together with their log files, the lock file is kept
+					bool skip = endsWith(ename, FileIndex::suffix) || endsWith(ename, ".lock");
+					if (ename.substr(0, base.size()) == base && !skip) {
 						name.push_back('/');
 						name.append(ename);
 						struct stat st;
@@ -85,21 +176,33 @@ inline void log4hpp::UnixFileRotatedAppender::do_rotate(std::time_t tm) {
 					files.resize(files.size()-days);
 					for (const auto &c: files) {
 						unlink(c.second.c_str());
+						unlink((c.second + FileIndex::suffix).c_str());
 					}
 				}
 
 			} catch(...) {
 				//empty;
 			}
+			closedir(d);
 		}
-		closedir(d);
 	}
 
 }
 
 
+
+#endif
+
 }
 
 
 
+#ifdef LOG4HPP_COMPILED
+#include "backend_impl.h"
+
+namespace log4hpp {
+LOG4HPP_EXTERN template class BackendT<UnixFileRotatedAppender>;
+}
+#endif
+
 #endif /* LOG4HPP_UNIX_FILE_ROTATE_APPENDER_H_ */
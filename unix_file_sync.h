@@ -0,0 +1,259 @@
+/*
+ * unix_file_sync.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_UNIX_FILE_SYNC_H_
+#define LOG4HPP_UNIX_FILE_SYNC_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "level.h"
+
+namespace log4hpp {
+
+///Durability policy of file appenders
+/**
+ * By default, the file is never synced, so an unknown tail of the log can be lost on power loss.
+ *
+ * @code
+ * //sync every second or after 4MB
+ * log4hpp::Backend<log4hpp::UnixFileAppender> logBackend(format, log4hpp::Level::debug, "app.log",
+ *         log4hpp::Durability::periodic(std::chrono::seconds(1), 4*1024*1024));
+ * //errors are on the disk before the log call returns
+ * log4hpp::Backend<log4hpp::UnixFileAppender> logBackend(format, log4hpp::Level::debug, "app.log",
+ *         log4hpp::Durability::onLevel(log4hpp::Level::error));
+ * @endcode
+ */
+struct Durability {
+	///interval of periodic sync (zero - disabled)
+	std::chrono::milliseconds interval = {};
+	///count of written bytes, which triggers the sync (zero - disabled)
+	std::size_t bytes = 0;
+	///messages with this level or more important are synced before the log call returns (nolevel - disabled)
+	Level::Type syncLevel = Level::nolevel;
+
+	///Never sync
+	static Durability none() {return Durability();}
+	///Sync periodically by the background thread
+	/**
+	 * @param interval interval of the sync
+	 * @param bytes sync also when this count of bytes has been written (0 - disabled)
+	 */
+	static Durability periodic(std::chrono::milliseconds interval, std::size_t bytes = 0) {
+		Durability d;
+		d.interval = interval;
+		d.bytes = bytes;
+		return d;
+	}
+	///Sync by the logging thread, when the message is important enough
+	/**
+	 * @param level the least important level, which is synced
+	 * @param interval other messages are synced periodically by the background thread (zero - disabled)
+	 */
+	static Durability onLevel(Level::Type level, std::chrono::milliseconds interval = {}) {
+		Durability d;
+		d.interval = interval;
+		d.syncLevel = level;
+		return d;
+	}
+
+	///Returns true, if the background sync is needed
+	bool background() const {return interval.count() > 0 || bytes > 0;}
+	///Returns true, if the message of given level must be synced before return
+	bool syncOnLevel(Level::Type level) const {return level != Level::nolevel && level <= syncLevel;}
+};
+
+///Background thread, which performs fdatasync() of a file
+/**
+ * The appender reports written bytes, the thread starts writeback of dirty pages by
+ * sync_file_range() as the data come (so the final fdatasync() has a little work) and calls
+ * fdatasync() after the interval or the count of bytes. The thread uses own duplicate of
+ * the file descriptor, so the appender can close or reopen the file at any time.
+ *
+ * More appenders can share the thread (UnixSegmentAppender), each of them registers its file
+ * under its own owner key. Written bytes are counted together, all files are synced at once.
+ */
+class FileSyncer {
+public:
+
+	///Constructor
+	/**
+	 * @param durability policy (background() must be true)
+	 * @param hintBytes count of bytes between writeback hints
+	 */
+	FileSyncer(const Durability &durability, std::size_t hintBytes = 1024*1024);
+	~FileSyncer();
+	FileSyncer(const FileSyncer &) = delete;
+	FileSyncer &operator=(const FileSyncer &) = delete;
+
+	///Sets file descriptor of the current file (descriptor is duplicated, -1 - no file to sync)
+	/**
+	 * Previous file of the owner is synced and closed by the background thread
+	 * @param fd file descriptor
+	 * @param owner key of the appender, which owns the file (when the thread is shared)
+	 */
+	void set_file(int fd, const void *owner = nullptr);
+
+	///Reports written bytes (called after each write)
+	void written(std::size_t sz) {
+		auto total = this->total.fetch_add(sz, std::memory_order_relaxed) + sz;
+		auto w = wakeAt.load(std::memory_order_relaxed);
+		if (total >= w && wakeAt.compare_exchange_strong(w, noWake, std::memory_order_relaxed)) {
+			{std::lock_guard _(mx);}
+			cond.notify_one();
+		}
+	}
+
+	///Returns count of failed syncs
+	std::size_t errors() const {return sync_errors.load(std::memory_order_relaxed);}
+	///Returns count of performed syncs
+	std::size_t syncs() const {return sync_count.load(std::memory_order_relaxed);}
+
+protected:
+	static constexpr std::size_t noWake = std::numeric_limits<std::size_t>::max();
+
+	Durability durability;
+	std::size_t hintBytes;
+	std::atomic<std::size_t> total = {0};
+	std::atomic<std::size_t> wakeAt = {noWake};
+	std::atomic<std::size_t> sync_errors = {0};
+	std::atomic<std::size_t> sync_count = {0};
+	std::mutex mx;
+	std::condition_variable cond;
+	struct File {
+		const void *owner;
+		int fd;
+	};
+	std::vector<File> files;
+	std::vector<int> retired;
+	bool stopping = false;
+	std::thread thr;
+
+	void run();
+	void sync(int f);
+	static void hint(int f);
+};
+
+#ifdef LOG4HPP_WITH_IMPL
+
+LOG4HPP_IMPL FileSyncer::FileSyncer(const Durability &durability, std::size_t hintBytes)
+:durability(durability),hintBytes(hintBytes) {
+	thr = std::thread([this]{run();});
+}
+
+LOG4HPP_IMPL FileSyncer::~FileSyncer() {
+	{
+		std::lock_guard _(mx);
+		stopping = true;
+	}
+	cond.notify_one();
+	thr.join();
+	for (const File &f: files) {
+		sync(f.fd);
+		::close(f.fd);
+	}
+}
+
+LOG4HPP_IMPL void FileSyncer::set_file(int f, const void *owner) {
+	int d = f >= 0?::fcntl(f, F_DUPFD_CLOEXEC, 0):-1;
+	{
+		std::lock_guard _(mx);
+		auto iter = std::find_if(files.begin(), files.end(), [&](const File &x){return x.owner == owner;});
+		if (iter != files.end()) {
+			retired.push_back(iter->fd);
+			files.erase(iter);
+		}
+		if (d >= 0) files.push_back({owner, d});
+	}
+	cond.notify_one();
+}
+
+LOG4HPP_IMPL void FileSyncer::sync(int f) {
+	hint(f);
+	if (::fdatasync(f)) sync_errors.fetch_add(1, std::memory_order_relaxed);
+	else sync_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+LOG4HPP_IMPL void FileSyncer::hint(int f) {
+#ifdef SYNC_FILE_RANGE_WRITE
+	::sync_file_range(f, 0, 0, SYNC_FILE_RANGE_WRITE);
+#else
+	(void)f;
+#endif
+}
+
+LOG4HPP_IMPL void FileSyncer::run() {
+	using Clock = std::chrono::steady_clock;
+	std::size_t syncedAt = 0;
+	std::size_t hintedAt = 0;
+	auto deadline = Clock::now() + durability.interval;
+	std::vector<int> closing;
+	std::vector<int> current;
+	std::unique_lock lk(mx);
+	while (!stopping) {
+		std::size_t nextWake = hintedAt + hintBytes;
+		if (durability.bytes) nextWake = std::min(nextWake, syncedAt + durability.bytes);
+		wakeAt.store(nextWake, std::memory_order_relaxed);
+		auto pred = [&]{
+			return stopping || !retired.empty() || total.load(std::memory_order_relaxed) >= nextWake;
+		};
+		bool timeout;
+		if (durability.interval.count() > 0) timeout = !cond.wait_until(lk, deadline, pred);
+		else {cond.wait(lk, pred);timeout = false;}
+		if (stopping) break;
+		closing.swap(retired);
+		for (const File &x: files) {
+			int f = ::fcntl(x.fd, F_DUPFD_CLOEXEC, 0);
+			if (f >= 0) current.push_back(f);
+		}
+		lk.unlock();
+		for (int c: closing) {
+			sync(c);
+			::close(c);
+		}
+		closing.clear();
+		std::size_t cur = total.load(std::memory_order_relaxed);
+		if (!current.empty()) {
+			if (timeout || (durability.bytes && cur - syncedAt >= durability.bytes)) {
+				if (cur != syncedAt) for (int f: current) sync(f);
+				syncedAt = cur;
+				hintedAt = cur;
+			} else if (cur - hintedAt >= hintBytes) {
+				for (int f: current) hint(f);
+				hintedAt = cur;
+			}
+			for (int f: current) ::close(f);
+			current.clear();
+		} else {
+			syncedAt = hintedAt = cur;
+		}
+		if (timeout) deadline = Clock::now() + durability.interval;
+		lk.lock();
+	}
+	for (int c: retired) {
+		sync(c);
+		::close(c);
+	}
+	retired.clear();
+}
+
+
+#endif
+
+}
+
+#endif /* LOG4HPP_UNIX_FILE_SYNC_H_ */
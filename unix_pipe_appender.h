@@ -0,0 +1,289 @@
+/*
+ * unix_pipe_appender.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_UNIX_PIPE_APPENDER_H_
+#define LOG4HPP_UNIX_PIPE_APPENDER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "record_queue.h"
+#include "stats.h"
+
+namespace log4hpp {
+
+///Writes lines to a named pipe (FIFO) without blocking the logging threads
+/**
+ * UnixFileAppender writes to the pipe in blocking mode, so a slow reader stalls every logging
+ * thread. This appender keeps the pipe in non-blocking mode. Lines are stored in a bounded queue,
+ * which is drained by a background thread when poll() reports the pipe writable. When the queue
+ * is full, the overflow policy is applied. Dropped lines are reported in-band, by the line
+ * `*** log4hpp: N lines dropped ***` written to the pipe before the next line.
+ *
+ * The pipe is opened when a reader is connected, lines are kept in the queue until then. When
+ * the reader disconnects, the pipe is reopened.
+ *
+ * @code
+ * log4hpp::Backend<log4hpp::UnixPipeAppender> logBackend("{t} {L} {c} {m}{nl}", log4hpp::Level::debug,
+ * 			"/run/myservice/log.fifo", 1024*1024, log4hpp::RecordQueue::Overflow::drop_below_level,
+ * 			log4hpp::Level::warning);
+ * @endcode
+ */
+class UnixPipeAppender {
+public:
+
+	///Constructor
+	/**
+	 * @param pathname path to the fifo
+	 * @param queueSize size of the queue in bytes
+	 * @param overflow overflow policy
+	 * @param dropLevel level for RecordQueue::Overflow::drop_below_level. Less important lines are
+	 * 	dropped when the queue is full
+	 * @param blockTimeout timeout for RecordQueue::Overflow::block
+	 */
+	UnixPipeAppender(const std::string_view &pathname,
+			std::size_t queueSize = 1024*1024,
+			RecordQueue::Overflow overflow = RecordQueue::Overflow::drop_newest,
+			Level::Type dropLevel = Level::warning,
+			std::chrono::milliseconds blockTimeout = std::chrono::milliseconds(100));
+
+	~UnixPipeAppender();
+
+	void operator()(const std::string_view &line, const LineInfo &info) {
+		queue.push(line, info);
+	}
+
+	void operator()(const std::string_view &line) {
+		queue.push(line, LineInfo());
+	}
+
+	///Writes line from the crash handler - async-signal-safe
+	void crash_write(const std::string_view &line);
+
+	///Writes queued lines from the crash handler - async-signal-safe
+	void crash_flush();
+
+	///Adds counters of the appender to the statistics
+	void stats(BackendStats &st) const {
+		st.dropped += queue.dropped() + dropped.load(std::memory_order_relaxed);
+		st.write_errors += write_errors.load(std::memory_order_relaxed);
+		st.queue_depth += queue.size();
+	}
+
+	///Returns true, if the reader is connected
+	bool isConnected() const {return fd >= 0;}
+
+protected:
+
+	static constexpr std::size_t maxBatch = 256;
+	static constexpr int maxIov = 64;
+	static constexpr std::chrono::milliseconds reopenDelay = std::chrono::milliseconds(100);
+	static constexpr std::chrono::milliseconds pollTimeout = std::chrono::milliseconds(1000);
+
+	std::string pathname;
+	RecordQueue queue;
+	std::atomic<int> fd = {-1};
+	std::atomic<std::size_t> dropped = {0};
+	std::atomic<std::size_t> write_errors = {0};
+
+	std::mutex stopLock;
+	std::condition_variable stopCond;
+	bool stopping = false;
+
+	RecordQueue::Batch batch;
+	///bytes of the first line of the batch already written
+	std::size_t offset = 0;
+	///in-band notice about dropped lines
+	std::string notice;
+	std::size_t reported = 0;
+
+	std::thread worker;
+
+	void run();
+	bool open_pipe();
+	void close_pipe();
+	bool isStopping();
+	void makeNotice();
+	///Writes as much as possible
+	/** @retval false pipe was closed by the reader */
+	bool writeSome();
+	static void writeAll(int f, const std::string_view &data);
+};
+
+inline UnixPipeAppender::UnixPipeAppender(const std::string_view &pathname, std::size_t queueSize,
+		RecordQueue::Overflow overflow, Level::Type dropLevel, std::chrono::milliseconds blockTimeout)
+	:pathname(pathname),queue(queueSize, overflow, dropLevel, blockTimeout)
+{
+	if (!open_pipe() && errno != ENXIO) {
+		int e = errno;
+		std::string msg("Can't open log pipe: ");
+		msg.append(pathname);
+		throw std::system_error(e,std::system_category(),msg);
+	}
+	worker = std::thread([this]{run();});
+}
+
+inline UnixPipeAppender::~UnixPipeAppender() {
+	{
+		std::lock_guard _(stopLock);
+		stopping = true;
+	}
+	stopCond.notify_all();
+	queue.close();
+	worker.join();
+	close_pipe();
+}
+
+inline bool UnixPipeAppender::open_pipe() {
+	//ENXIO - no reader yet
+	int f = ::open(pathname.c_str(), O_WRONLY|O_CLOEXEC|O_NONBLOCK);
+	if (f < 0) return false;
+	signal(SIGPIPE, SIG_IGN);
+	fd.store(f);
+	return true;
+}
+
+inline void UnixPipeAppender::close_pipe() {
+	int f = fd.exchange(-1);
+	if (f >= 0) ::close(f);
+}
+
+inline bool UnixPipeAppender::isStopping() {
+	std::lock_guard _(stopLock);
+	return stopping;
+}
+
+inline void UnixPipeAppender::makeNotice() {
+	std::size_t d = queue.dropped() + dropped.load(std::memory_order_relaxed);
+	if (d == reported || !notice.empty()) return;
+	notice = "*** log4hpp: " + std::to_string(d - reported) + " lines dropped ***\n";
+	reported = d;
+}
+
+inline void UnixPipeAppender::run() {
+	bool closed = false;
+	while (true) {
+		if (fd < 0 && !open_pipe()) {
+			if (closed) break;
+			std::unique_lock lk(stopLock);
+			closed = stopCond.wait_for(lk, reopenDelay, [&]{return stopping;});
+			continue;
+		}
+		if (batch.empty()) {
+			if (!queue.pop(batch, maxBatch, pollTimeout)) break;
+			offset = 0;
+		}
+		//the notice is never inserted into a partially written line
+		if (offset == 0) makeNotice();
+		if (batch.empty() && notice.empty()) continue;
+		pollfd pfd = {fd, POLLOUT, 0};
+		int r = ::poll(&pfd, 1, static_cast<int>(pollTimeout.count()));
+		if (r < 0) continue;
+		if (r == 0) {
+			//reader doesn't read, don't wait for it during shutdown
+			if (isStopping()) break;
+			continue;
+		}
+		if ((pfd.revents & (POLLERR|POLLHUP)) || !writeSome()) {
+			close_pipe();
+			//the partially written line is written again to the next reader
+			offset = 0;
+			if (isStopping()) break;
+		}
+	}
+	dropped.fetch_add(batch.size() + queue.size(), std::memory_order_relaxed);
+}
+
+inline bool UnixPipeAppender::writeSome() {
+	iovec iov[maxIov];
+	int cnt = 0;
+	std::size_t noticeSize = notice.size();
+	if (noticeSize) {
+		iov[cnt].iov_base = notice.data();
+		iov[cnt].iov_len = noticeSize;
+		++cnt;
+	}
+	for (std::size_t i = 0; i < batch.size() && cnt < maxIov; i++) {
+		auto line = batch[i].line;
+		if (i == 0) line = line.substr(offset);
+		iov[cnt].iov_base = const_cast<char *>(line.data());
+		iov[cnt].iov_len = line.size();
+		++cnt;
+	}
+	auto r = ::writev(fd, iov, cnt);
+	if (r < 0) {
+		if (errno == EAGAIN || errno == EINTR) return true;
+		++write_errors;
+		return false;
+	}
+	std::size_t written = r;
+	if (noticeSize) {
+		std::size_t n = std::min(written, noticeSize);
+		notice.erase(0, n);
+		written -= n;
+		if (!notice.empty()) return true;
+	}
+	std::size_t done = 0;
+	while (done < batch.size()) {
+		std::size_t rest = batch[done].line.size() - offset;
+		if (written < rest) {
+			offset += written;
+			break;
+		}
+		written -= rest;
+		offset = 0;
+		++done;
+	}
+	batch.consume(done);
+	return true;
+}
+
+inline void UnixPipeAppender::writeAll(int f, const std::string_view &data) {
+	std::size_t p = 0;
+	int retry = 100;
+	while (p < data.size()) {
+		auto s = ::write(f, data.data()+p, data.size()-p);
+		if (s < 0 && errno == EAGAIN && --retry > 0) {
+			//pipe is full, give the reader a chance in the crash handler
+			pollfd pfd = {f, POLLOUT, 0};
+			::poll(&pfd, 1, 10);
+			continue;
+		}
+		if (s <= 0) break;
+		p+=s;
+	}
+}
+
+inline void UnixPipeAppender::crash_write(const std::string_view &line) {
+	int f = fd;
+	writeAll(f < 0?STDERR_FILENO:f, line);
+}
+
+inline void UnixPipeAppender::crash_flush() {
+	queue.crash_drain([&](const std::string_view &line, const LineInfo &) {
+		crash_write(line);
+	});
+}
+
+}
+
+
+
+#endif /* LOG4HPP_UNIX_PIPE_APPENDER_H_ */
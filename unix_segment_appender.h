@@ -0,0 +1,218 @@
+/*
+ * unix_segment_appender.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_UNIX_SEGMENT_APPENDER_H_
+#define LOG4HPP_UNIX_SEGMENT_APPENDER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "unix_file_rotate_appender.h"
+
+namespace log4hpp {
+
+///Each thread group writes its own file
+/**
+ * Lines of the thread are written to the file `<pathname>.<id>.seg`, where id is the thread id
+ * modulo count of groups. Only threads of the same group share the file, so the threads
+ * rarely wait for each other. The count of groups is bounded (by default, it is the count of CPUs),
+ * so the count of open files doesn't grow with threads, which are started and finished during
+ * the run. Each segment is rotated and pruned as UnixFileRotatedAppender, the background sync
+ * (Durability) is performed by single thread for all segments.
+ *
+ * The segments can be merged by the tool log4hpp-merge. Lines are ordered by the message
+ * number {N} with Numbering::hlc (or global), or by the time with fraction of the second
+ * (block and thread numbering don't give order between threads)
+ *
+ * @code
+ * log4hpp::Backend<log4hpp::UnixSegmentAppender> logBackend("{N} {t} {L} {T} {c} {m}{nl}",
+ * 			log4hpp::Level::debug, "log/service.log");
+ * logBackend.setNumbering(log4hpp::Numbering::hlc);
+ * @endcode
+ *
+ * merge: log4hpp-merge -m num -n 1 log/service.log.*.seg > service.log
+ *
+ * or with the format "{t[%FT%T.%NZ]} {L} {T} {c} {m}{nl}": log4hpp-merge -t 1 log/service.log.*.seg
+ */
+class UnixSegmentAppender {
+public:
+
+	///Constructor
+	/**
+	 * @param pathname base path of segments
+	 * @param groups count of thread groups. Zero means count of CPUs
+	 * @param days days to keep rotated segments (per segment)
+	 * @param day_seconds length of day in seconds
+	 * @param dateformat format of date in names of rotated segments
+	 * @param durability durability policy of each segment
+	 */
+	UnixSegmentAppender(const std::string_view &pathname, unsigned int groups = 0,
+			unsigned long days = 7, unsigned long day_seconds = 24*60*60,
+			const std::string_view &dateformat="%Y%m%d", const Durability &durability = Durability());
+	~UnixSegmentAppender();
+
+	void operator()(const std::string_view &line, const LineInfo &info) {
+		segment(info.threadId)(line, info);
+	}
+
+	void operator()(const std::string_view &line) {
+		segment(0)(line);
+	}
+
+	///Segments are rotated by the time of the message
+	bool needs_time() const {return true;}
+
+	///Writes line from the crash handler - async-signal-safe
+	/** Line is written to the segment 0, which is created by the constructor */
+	void crash_write(const std::string_view &line);
+
+	///Syncs the segment 0 from the crash handler - async-signal-safe
+	void crash_flush();
+
+	///Adds counters of all segments to the statistics
+	void stats(BackendStats &st) const;
+
+	///Returns path of the segment
+	std::string getSegmentPath(unsigned int id) const;
+
+protected:
+
+	static constexpr unsigned int chunkSize = 256;
+	static constexpr unsigned int chunkCount = 256;
+
+	using Segment = UnixFileRotatedAppender;
+	struct Chunk {
+		std::atomic<Segment *> items[chunkSize] = {};
+	};
+
+	std::string pathname;
+	unsigned int groups;
+	unsigned long days;
+	unsigned long day_seconds;
+	std::string dateformat;
+	Durability durability;
+	///background sync of all segments
+	std::shared_ptr<FileSyncer> syncer;
+	///two-level table of segments - lookup is lock-free, segments are created by the owning thread
+	std::atomic<Chunk *> chunks[chunkCount] = {};
+
+	Segment &segment(ThreadId threadId);
+	Segment *find(unsigned int id) const;
+	Segment &create(unsigned int id);
+};
+
+inline UnixSegmentAppender::UnixSegmentAppender(const std::string_view &pathname, unsigned int groups,
+		unsigned long days, unsigned long day_seconds, const std::string_view &dateformat,
+		const Durability &durability)
+:pathname(pathname),groups(groups?groups:std::max(1U, std::thread::hardware_concurrency()))
+,days(days),day_seconds(day_seconds),dateformat(dateformat)
+,durability(durability)
+,syncer(durability.background()?std::make_shared<FileSyncer>(durability):nullptr)
+{
+	//check, that the directory is writable. The segment 0 is kept, it receives lines of the crash handler
+	auto seg = std::make_unique<Segment>(getSegmentPath(0), days, day_seconds, dateformat, durability, syncer);
+	Chunk *ch = new Chunk;
+	ch->items[0].store(seg.release());
+	chunks[0].store(ch);
+}
+
+inline UnixSegmentAppender::~UnixSegmentAppender() {
+	for (auto &c: chunks) {
+		Chunk *ch = c.load();
+		if (ch) {
+			for (auto &s: ch->items) delete s.load();
+			delete ch;
+		}
+	}
+}
+
+inline std::string UnixSegmentAppender::getSegmentPath(unsigned int id) const {
+	std::string s(pathname);
+	s.push_back('.');
+	s.append(std::to_string(id));
+	s.append(".seg");
+	return s;
+}
+
+inline UnixSegmentAppender::Segment *UnixSegmentAppender::find(unsigned int id) const {
+	unsigned int c = id / chunkSize;
+	if (c >= chunkCount) return nullptr;
+	Chunk *ch = chunks[c].load(std::memory_order_acquire);
+	if (!ch) return nullptr;
+	return ch->items[id % chunkSize].load(std::memory_order_acquire);
+}
+
+inline UnixSegmentAppender::Segment &UnixSegmentAppender::segment(ThreadId threadId) {
+	unsigned int id = threadId % groups;
+	//groups above the table share the last segment
+	if (id >= chunkSize * chunkCount) id = chunkSize * chunkCount - 1;
+	Segment *s = find(id);
+	if (s) return *s;
+	return create(id);
+}
+
+inline UnixSegmentAppender::Segment &UnixSegmentAppender::create(unsigned int id) {
+	auto &cptr = chunks[id / chunkSize];
+	Chunk *ch = cptr.load(std::memory_order_acquire);
+	if (!ch) {
+		Chunk *nch = new Chunk;
+		if (cptr.compare_exchange_strong(ch, nch, std::memory_order_acq_rel)) {
+			ch = nch;
+		} else {
+			delete nch;
+		}
+	}
+	auto &sptr = ch->items[id % chunkSize];
+	//more threads of the group can create the segment at the same time
+	Segment *s = sptr.load(std::memory_order_acquire);
+	if (s) return *s;
+	Segment *ns = new Segment(getSegmentPath(id), days, day_seconds, dateformat, durability, syncer);
+	if (sptr.compare_exchange_strong(s, ns, std::memory_order_acq_rel)) return *ns;
+	delete ns;
+	return *s;
+}
+
+inline void UnixSegmentAppender::crash_write(const std::string_view &line) {
+	Segment *s = find(0);
+	if (s) {
+		s->crash_write(line);
+	} else {
+		std::size_t p = 0;
+		while (p < line.size()) {
+			auto r = ::write(STDERR_FILENO, line.data()+p, line.size()-p);
+			if (r <= 0) break;
+			p+=r;
+		}
+	}
+}
+
+inline void UnixSegmentAppender::crash_flush() {
+	Segment *s = find(0);
+	if (s) s->crash_flush();
+}
+
+inline void UnixSegmentAppender::stats(BackendStats &st) const {
+	if (syncer) st.write_errors += syncer->errors();
+	for (auto &c: chunks) {
+		Chunk *ch = c.load(std::memory_order_acquire);
+		if (ch) {
+			for (auto &s: ch->items) {
+				Segment *seg = s.load(std::memory_order_acquire);
+				if (seg) seg->stats(st);
+			}
+		}
+	}
+}
+
+}
+
+
+
+#endif /* LOG4HPP_UNIX_SEGMENT_APPENDER_H_ */
@@ -0,0 +1,373 @@
+/*
+ * unix_socket_appender.h
+ *
+ *  Created on: 19. 10. 2026
+ *      Author: ondra
+ */
+
+#ifndef LOG4HPP_UNIX_SOCKET_APPENDER_H_
+#define LOG4HPP_UNIX_SOCKET_APPENDER_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "record_queue.h"
+#include "stats.h"
+
+namespace log4hpp {
+
+///Sends lines to a local unix socket (syslog - /dev/log, journald, local collector)
+/**
+ * Logging thread only copies the line to the queue. The lines are sent by a background
+ * thread in batches (sendmmsg() for datagram sockets, single send() for stream sockets). Each
+ * line is prefixed by the syslog header (RFC5424 or RFC3164). When the socket is not available,
+ * the background thread reconnects with increasing delay, the lines are kept in the queue
+ * (until it is full). A send blocked by a stuck reader times out after one second and the
+ * connection is reopened.
+ *
+ * Severity is derived from the level of the message. The format should not contain
+ * time and level, because they are part of the syslog header.
+ *
+ * @code
+ * log4hpp::Backend<log4hpp::UnixSocketAppender> logBackend("{T} {c} {m}{nl}", log4hpp::Level::info,
+ * 			"/dev/log", log4hpp::UnixSocketAppender::Type::datagram,
+ * 			log4hpp::UnixSocketAppender::Format::rfc3164, "myservice");
+ * @endcode
+ */
+class UnixSocketAppender: public RecordSender {
+public:
+
+	///Type of the socket
+	enum class Type {
+		datagram,
+		stream
+	};
+
+	///Format of the header
+	enum class Format {
+		///<PRI>1 TIMESTAMP HOSTNAME APP PID - - MSG, stream uses octet counting framing
+		rfc5424,
+		///<PRI>Mmm dd hh:mm:ss APP[PID]: MSG, stream uses newline framing
+		rfc3164
+	};
+
+	///Constructor
+	/**
+	 * @param path path to the socket
+	 * @param type type of the socket
+	 * @param format format of the header
+	 * @param appName application name (empty - name of the program)
+	 * @param facility syslog facility (1 - user, 16-23 - local0-local7)
+	 * @param queueSize size of the queue in bytes
+	 * @param overflow what to do, when the queue is full
+	 */
+	UnixSocketAppender(const std::string_view &path = "/dev/log",
+			Type type = Type::datagram,
+			Format format = Format::rfc3164,
+			const std::string_view &appName = std::string_view(),
+			unsigned int facility = 1,
+			std::size_t queueSize = 1024*1024,
+			RecordQueue::Overflow overflow = RecordQueue::Overflow::drop_newest);
+
+	~UnixSocketAppender();
+
+	void operator()(const std::string_view &line, const LineInfo &info) {
+		queue.push(line, info);
+	}
+
+	void operator()(const std::string_view &line) {
+		queue.push(line, LineInfo());
+	}
+
+	///The header contains the time of the message
+	bool needs_time() const {return true;}
+
+	///Writes line from the crash handler - async-signal-safe
+	void crash_write(const std::string_view &line);
+
+	///Sends queued lines from the crash handler - async-signal-safe
+	void crash_flush();
+
+	///Maps level to syslog severity
+	static unsigned int severity(Level::Type level);
+
+protected:
+
+	static constexpr std::size_t maxBatch = 64;
+	static constexpr std::chrono::milliseconds minBackoff = std::chrono::milliseconds(50);
+	static constexpr std::chrono::milliseconds maxBackoff = std::chrono::milliseconds(5000);
+	static constexpr std::chrono::milliseconds sendTimeout = std::chrono::milliseconds(1000);
+
+	std::string path;
+	Type type;
+	Format format;
+	unsigned int facility;
+	///static part of the header after the timestamp
+	std::string hdrTail;
+
+	///cached timestamp (second precision)
+	std::time_t tsSec = -1;
+	char tsBuff[32];
+	std::size_t tsLen = 0;
+
+	///buffers of the sender thread
+	std::string hdrs;
+	std::vector<std::size_t> hdrEnds;
+
+	virtual bool connect() override;
+	virtual bool sendBatch() override;
+	bool sendDatagrams();
+	bool sendLines();
+	///Builds headers of all lines in the batch
+	void buildHeaders();
+	///Formats header into the buffer (no allocation)
+	std::size_t formatHeader(char *buff, std::size_t size, unsigned int sev,
+			std::chrono::system_clock::time_point tp);
+	void updateTimestamp(std::time_t sec);
+	static std::size_t writeNum(char *buff, std::size_t val) {
+		char tmp[24];
+		std::size_t n = 0;
+		do {tmp[n++] = '0' + val % 10; val /= 10;} while (val);
+		for (std::size_t i = 0; i < n; i++) buff[i] = tmp[n-i-1];
+		return n;
+	}
+};
+
+inline UnixSocketAppender::UnixSocketAppender(const std::string_view &path, Type type, Format format,
+		const std::string_view &appName, unsigned int facility, std::size_t queueSize,
+		RecordQueue::Overflow overflow)
+	:RecordSender(queueSize, overflow, maxBatch, minBackoff, maxBackoff)
+	,path(path),type(type),format(format),facility(facility & 0x1F)
+{
+	std::string app(appName);
+#ifdef __GLIBC__
+	if (app.empty()) app = program_invocation_short_name;
+#endif
+	if (app.empty()) app = "-";
+	std::string pid = std::to_string(::getpid());
+	if (format == Format::rfc5424) {
+		char host[256];
+		if (gethostname(host, sizeof(host)) || host[0] == 0) std::strcpy(host, "-");
+		host[sizeof(host)-1] = 0;
+		hdrTail.append(" ").append(host).append(" ").append(app).append(" ").append(pid).append(" - - ");
+	} else {
+		hdrTail.append(" ").append(app).append("[").append(pid).append("]: ");
+	}
+	connect();
+	start();
+}
+
+inline UnixSocketAppender::~UnixSocketAppender() {
+	stop();
+}
+
+inline unsigned int UnixSocketAppender::severity(Level::Type level) {
+	if (level == Level::nolevel) return 5;
+	if (level <= Level::fatal) return 2;
+	if (level <= Level::error) return 3;
+	if (level <= Level::warning) return 4;
+	if (level <= Level::note) return 5;
+	if (level <= Level::info) return 6;
+	return 7;
+}
+
+inline bool UnixSocketAppender::connect() {
+	int s = ::socket(AF_UNIX, (type == Type::datagram?SOCK_DGRAM:SOCK_STREAM)|SOCK_CLOEXEC, 0);
+	if (s < 0) return false;
+	//the sender thread must not block forever, when the reader is stuck
+	timeval tv = {sendTimeout.count() / 1000, (sendTimeout.count() % 1000) * 1000};
+	setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+	if (::connect(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))) {
+		::close(s);
+		return false;
+	}
+	fd.store(s);
+	return true;
+}
+
+inline bool UnixSocketAppender::sendBatch() {
+	buildHeaders();
+	return type == Type::datagram?sendDatagrams():sendLines();
+}
+
+inline void UnixSocketAppender::buildHeaders() {
+	hdrs.clear();
+	hdrEnds.clear();
+	for (std::size_t i = 0, cnt = batch.size(); i < cnt; i++) {
+		auto rec = batch[i];
+		char buff[512];
+		std::size_t len = formatHeader(buff, sizeof(buff), severity(rec.info.level), rec.time);
+		if (type == Type::stream && format == Format::rfc5424) {
+			//octet counting framing: MSG-LEN SP SYSLOG-MSG
+			char num[24];
+			std::size_t nl = writeNum(num, len + trimLine(rec.line).size());
+			hdrs.append(num, nl);
+			hdrs.push_back(' ');
+		}
+		hdrs.append(buff, len);
+		hdrEnds.push_back(hdrs.size());
+	}
+}
+
+inline bool UnixSocketAppender::sendDatagrams() {
+	mmsghdr msgs[maxBatch];
+	iovec iov[maxBatch*2];
+	std::size_t cnt = std::min(batch.size(), maxBatch);
+	for (std::size_t i = 0; i < cnt; i++) {
+		std::size_t hb = i?hdrEnds[i-1]:0;
+		auto line = trimLine(batch[i].line);
+		iov[i*2].iov_base = hdrs.data()+hb;
+		iov[i*2].iov_len = hdrEnds[i]-hb;
+		iov[i*2+1].iov_base = const_cast<char *>(line.data());
+		iov[i*2+1].iov_len = line.size();
+		msgs[i] = {};
+		msgs[i].msg_hdr.msg_iov = iov+i*2;
+		msgs[i].msg_hdr.msg_iovlen = 2;
+	}
+	std::size_t sent = 0;
+	while (sent < cnt) {
+		int r = ::sendmmsg(fd, msgs+sent, cnt-sent, MSG_NOSIGNAL);
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			++write_errors;
+			if (errno == EMSGSIZE) {
+				//line is too long for the datagram, skip it
+				++dropped;
+				batchProgress(++sent);
+				continue;
+			}
+			consume(sent);
+			return false;
+		}
+		sent += r;
+		batchProgress(sent);
+	}
+	consume(sent);
+	return true;
+}
+
+inline bool UnixSocketAppender::sendLines() {
+	//headers and lines are joined into the single buffer
+	out.clear();
+	ends.clear();
+	std::size_t cnt = batch.size();
+	for (std::size_t i = 0; i < cnt; i++) {
+		std::size_t hb = i?hdrEnds[i-1]:0;
+		out.append(hdrs.data()+hb, hdrEnds[i]-hb);
+		out.append(trimLine(batch[i].line));
+		if (format == Format::rfc3164) out.push_back('\n');
+		ends.push_back(out.size());
+	}
+	return sendStream(fd);
+}
+
+inline void UnixSocketAppender::updateTimestamp(std::time_t sec) {
+	struct tm tm;
+	if (format == Format::rfc5424) {
+		gmtime_r(&sec, &tm);
+		tsLen = std::strftime(tsBuff, sizeof(tsBuff), "%Y-%m-%dT%H:%M:%S", &tm);
+	} else {
+		localtime_r(&sec, &tm);
+		tsLen = std::strftime(tsBuff, sizeof(tsBuff), "%b %e %H:%M:%S", &tm);
+	}
+	tsSec = sec;
+}
+
+inline std::size_t UnixSocketAppender::formatHeader(char *buff, std::size_t size, unsigned int sev,
+		std::chrono::system_clock::time_point tp) {
+	auto us = std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count();
+	std::time_t sec = static_cast<std::time_t>(us / 1000000);
+	if (sec != tsSec) updateTimestamp(sec);
+	char tmp[64];
+	std::size_t p = 0;
+	tmp[p++] = '<';
+	p += writeNum(tmp+p, facility * 8 + sev);
+	tmp[p++] = '>';
+	if (format == Format::rfc5424) {
+		tmp[p++] = '1';
+		tmp[p++] = ' ';
+	}
+	std::memcpy(tmp+p, tsBuff, tsLen);
+	p += tsLen;
+	if (format == Format::rfc5424) {
+		unsigned long frac = us % 1000000;
+		tmp[p++] = '.';
+		for (int i = 5; i >= 0; i--) {tmp[p+i] = '0' + frac % 10; frac /= 10;}
+		p += 6;
+		tmp[p++] = 'Z';
+	}
+	std::size_t total = std::min(size, p + hdrTail.size());
+	std::size_t first = std::min(p, total);
+	std::memcpy(buff, tmp, first);
+	std::memcpy(buff+first, hdrTail.data(), total - first);
+	return total;
+}
+
+inline void UnixSocketAppender::crash_write(const std::string_view &line) {
+	int s = fd;
+	//timestamp is taken from the cache, it is not formatted in the signal handler
+	char buff[1024];
+	std::size_t p = 0;
+	auto ln = trimLine(line);
+	buff[p++] = '<';
+	p += writeNum(buff+p, facility * 8 + severity(Level::fatal));
+	buff[p++] = '>';
+	if (format == Format::rfc5424) {
+		std::memcpy(buff+p, "1 -", 3);
+		p+=3;
+	} else if (tsLen) {
+		std::memcpy(buff+p, tsBuff, tsLen);
+		p+=tsLen;
+	}
+	std::size_t tl = std::min(hdrTail.size(), sizeof(buff) - p);
+	std::memcpy(buff+p, hdrTail.data(), tl);
+	p+=tl;
+	if (s < 0) {
+		//not connected - the line goes to the stderr (which is not a socket)
+		writeAll(STDERR_FILENO, buff, p);
+		writeAll(STDERR_FILENO, ln.data(), ln.size());
+		writeAll(STDERR_FILENO, "\n", 1);
+	} else if (type == Type::datagram) {
+		iovec iov[2] = {{buff, p},{const_cast<char *>(ln.data()), ln.size()}};
+		msghdr msg = {};
+		msg.msg_iov = iov;
+		msg.msg_iovlen = 2;
+		::sendmsg(s, &msg, MSG_NOSIGNAL);
+	} else {
+		if (format == Format::rfc5424) {
+			char num[24];
+			std::size_t nl = writeNum(num, p + ln.size());
+			num[nl++] = ' ';
+			sendAll(s, num, nl);
+		}
+		sendAll(s, buff, p);
+		sendAll(s, ln.data(), ln.size());
+		if (format == Format::rfc3164) sendAll(s, "\n", 1);
+	}
+}
+
+inline void UnixSocketAppender::crash_flush() {
+	crash_drain(fd, [&](const std::string_view &line) {
+		crash_write(line);
+	});
+}
+
+}
+
+
+
+#endif /* LOG4HPP_UNIX_SOCKET_APPENDER_H_ */